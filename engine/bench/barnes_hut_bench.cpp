@@ -0,0 +1,113 @@
+/**
+ * Accuracy against speed of BarnesHutEnvironment over direct summation
+ * (ConcreteEnvironment) for N = 10 to 10k bodies, half stationary and half
+ * on elliptical orbits. Each query time stands for one expansion: the cache
+ * is reset, then a batch of ship positions is evaluated at the four RK4
+ * stage times of one step.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "simulation/world.h"
+#include "simulation/barnes_hut.h"
+
+namespace {
+
+constexpr f64 EXTENT = 1e6;             // km
+constexpr size_t SHIPS = 24;            // actions per expansion
+constexpr size_t EXPANSIONS = 64;
+constexpr f64 DT = 60.0;                // s
+
+WorldData makeWorld(size_t n, std::mt19937_64& gen) {
+    std::uniform_real_distribution<f64> coord(-EXTENT, EXTENT), unit(0.0, 1.0);
+    shared_vec<CelestialBody> bodies;
+    for (u32 i = 0; i < n; ++i) {
+        f64 mass = 1e20 * (1.0 + 99.0 * unit(gen));
+        Vec2 center(coord(gen), coord(gen));
+        if (i % 2 == 0) {
+            bodies.push_back(std::make_shared<StationaryBody>(i, 10.0, mass, center));
+        } else {
+            f64 a = 1e3 + 5e4 * unit(gen);
+            bodies.push_back(std::make_shared<OrbitingBody>(
+                i, 10.0, mass,
+                std::make_unique<EllipticalOrbit>(a, (0.5 + 0.5 * unit(gen)) * a, 1e-5 * (1.0 + unit(gen)),
+                    6.28 * unit(gen), center, 6.28 * unit(gen))
+            ));
+        }
+    }
+    return WorldData(bodies, {}, {}, 1e6);
+}
+
+struct Query {
+    Vec2 position;
+    f64 t_u;
+};
+
+/**
+ * Returns ns per gravity query, averaged over the expansions.
+ */
+double timeQueries(const EnvironmentModel& env, const std::vector<Query>& queries) {
+    double ns = bench::nsPerCall(1, [&] {
+        Vec2 acc;
+        for (size_t e = 0; e < EXPANSIONS; ++e) {
+            env.resetCache();
+            for (size_t k = e * SHIPS * 4; k < (e + 1) * SHIPS * 4; ++k) {
+                acc += env.gravity(queries[k].position, queries[k].t_u);
+            }
+        }
+        bench::doNotOptimize(acc);
+    }, 3);
+    return ns / queries.size();
+}
+
+}
+
+int main() {
+    std::printf("%-7s %-12s %12s %9s %12s %12s\n", "N", "env", "ns/query", "speedup", "mean rel", "max rel");
+
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<f64> coord(-EXTENT, EXTENT);
+    for (size_t n : {10, 100, 1000, 10000}) {
+        auto world = makeWorld(n, gen);
+
+        // Stage times t, t + dt/2, t + dt/2, t + dt of one step per expansion.
+        std::vector<Query> queries;
+        for (size_t e = 0; e < EXPANSIONS; ++e) {
+            f64 t = 1e4 * e;
+            for (size_t s = 0; s < SHIPS; ++s) {
+                Vec2 p(coord(gen), coord(gen));
+                for (f64 dt : {0.0, DT / 2.0, DT / 2.0, DT}) {
+                    queries.push_back({p, t + dt});
+                }
+            }
+        }
+
+        ref::ConcreteEnvironment direct(world);
+        std::vector<Vec2> exact(queries.size());
+        for (size_t k = 0; k < queries.size(); ++k) {
+            exact[k] = direct.gravity(queries[k].position, queries[k].t_u);
+        }
+        double direct_ns = timeQueries(direct, queries);
+        std::printf("%-7zu %-12s %12.1f %9s %12s %12s\n", n, "direct", direct_ns, "1.0x", "-", "-");
+
+        for (f64 theta : {0.3, 0.5, 0.7}) {
+            ref::BarnesHutEnvironment bh(world, theta, 1.0);
+            f64 sum = 0.0, worst = 0.0;
+            for (size_t k = 0; k < queries.size(); ++k) {
+                f64 err = MathConfig::norm<2>(bh.gravity(queries[k].position, queries[k].t_u) - exact[k])
+                    / MathConfig::norm<2>(exact[k]);
+                sum += err;
+                worst = std::max(worst, err);
+            }
+            double ns = timeQueries(bh, queries);
+            char name[16];
+            std::snprintf(name, sizeof(name), "BH %.1f", theta);
+            std::printf("%-7s %-12s %12.1f %8.1fx %12.2e %12.2e\n",
+                "", name, ns, direct_ns / ns, sum / queries.size(), worst);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+
+/**
+ * Minimal timing helpers shared by the microbenchmarks. Each benchmark is its
+ * own executable printing one table; build with optimizations (Release).
+ */
+namespace bench {
+
+/**
+ * Keeps the compiler from discarding the computation of value.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * Runs f() iterations times, repeats times over, and returns the fastest
+ * run in nanoseconds per call. One untimed run warms caches first.
+ */
+template <typename F>
+inline double nsPerCall(size_t iterations, F&& f, size_t repeats = 5) {
+    using clock = std::chrono::steady_clock;
+    for (size_t i = 0; i < iterations; ++i) {
+        f();
+    }
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t r = 0; r < repeats; ++r) {
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            f();
+        }
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(iterations));
+    }
+    return best;
+}
+
+}
@@ -0,0 +1,109 @@
+/**
+ * Energy drift of the coast integrators over a long horizon: RK4 against
+ * velocity Verlet and Yoshida-4 on an eccentric orbit around one point mass,
+ * with the number of field evaluations per simulated hour.
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "bench.h"
+#include "utils/math.h"
+
+namespace {
+
+constexpr f64 GM = 3.986e5;                     // km^3 / s^2
+constexpr f64 HORIZON = 30.0 * 86400.0;         // s
+const Vec2 X0(7000.0, 0.0);                     // periapsis, e = 0.6
+const Vec2 V0(0.0, std::sqrt(GM * 1.6 / 7000.0));
+
+struct Orbit {
+    Vec2 x, v;
+
+    Orbit operator+(const Orbit& o) const { return {x + o.x, v + o.v}; }
+    Orbit operator*(f64 s) const { return {x * s, v * s}; }
+};
+
+inline f64 energy(const Vec2& x, const Vec2& v) {
+    return 0.5 * MathConfig::norm2Sq(v) - GM / std::sqrt(MathConfig::norm2Sq(x));
+}
+
+struct Result {
+    f64 day1_drift = 0.0f, max_drift = 0.0f;
+    size_t evals = 0;
+    double ms = 0.0;
+};
+
+/**
+ * Runs step(x, v, t, h, accel) to HORIZON, tracking the largest |dE/E| over
+ * the first day and over the whole run: equal for a bounded error, growing
+ * with the horizon for a drifting one.
+ */
+template <typename Step>
+Result run(f64 h, Step&& step) {
+    Result result;
+    auto accel = [&] (const Vec2& x, f64) {
+        ++result.evals;
+        f64 d2 = MathConfig::norm2Sq(x);
+        return x * (-GM / (d2 * std::sqrt(d2)));
+    };
+
+    Vec2 x = X0, v = V0;
+    f64 e0 = energy(x, v);
+    auto start = std::chrono::steady_clock::now();
+    for (f64 t = 0.0; t < HORIZON; t += h) {
+        step(x, v, t, h, accel);
+        result.max_drift = std::max(result.max_drift, std::fabs((energy(x, v) - e0) / e0));
+        if (t < 86400.0) {
+            result.day1_drift = result.max_drift;
+        }
+    }
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void report(const char* name, f64 h, const Result& r) {
+    std::printf(
+        "%-10s %6.0f %12.2e %12.2e %10.0f %9.1f\n",
+        name, h, r.day1_drift, r.max_drift, r.evals / (HORIZON / 3600.0), r.ms
+    );
+}
+
+}
+
+int main() {
+    std::printf(
+        "%-10s %6s %12s %12s %10s %9s\n",
+        "scheme", "dt s", "day 1 dE/E", "30 d dE/E", "evals/h", "ms"
+    );
+
+    for (f64 h : {30.0, 60.0}) {
+        MathConfig::RK4Workspace<Orbit> ws;
+        report("RK4", h, run(h, [&] (Vec2& x, Vec2& v, f64 t, f64 dt, auto& accel) {
+            Orbit s{x, v};
+            MathConfig::rk4Step(s, t, dt, [&] (const Orbit& o, f64 ts, Orbit& out) {
+                out = {o.v, accel(o.x, ts)};
+            }, ws);
+            x = s.x;
+            v = s.v;
+        }));
+    }
+
+    for (f64 h : {15.0, 30.0}) {
+        bool primed = false;
+        Vec2 acc;
+        report("Verlet", h, run(h, [&] (Vec2& x, Vec2& v, f64 t, f64 dt, auto& accel) {
+            if (!primed) {
+                acc = accel(x, t);
+                primed = true;
+            }
+            MathConfig::velocityVerletStep(x, v, acc, t, dt, accel);
+        }));
+    }
+
+    for (f64 h : {60.0, 120.0}) {
+        report("Yoshida4", h, run(h, [&] (Vec2& x, Vec2& v, f64 t, f64 dt, auto& accel) {
+            MathConfig::yoshida4Step(x, v, t, dt, accel);
+        }));
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * Throughput of the simd gravity kernel per instruction set against the
+ * scalar one, and what it buys end to end: ConcreteEnvironment::evaluate()
+ * point by point against evaluateBatch(), and one expansion of thrust
+ * actions applied one by one against in lockstep.
+ */
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "simulation/actions.h"
+#include "utils/simd.h"
+
+namespace {
+
+// Subtractions, squares, sqrt, divisions and sums per body-query interaction.
+constexpr f64 FLOPS_PER_INTERACTION = 14.0;
+
+WorldData makeWorld(size_t n, std::mt19937_64& gen) {
+    std::uniform_real_distribution<f64> unit(0.0, 1.0);
+    shared_vec<CelestialBody> bodies;
+    for (u32 i = 0; i < n; ++i) {
+        f64 r = 2e3 * (i + 1);
+        bodies.push_back(std::make_shared<OrbitingBody>(
+            i, 10.0, 1e21, std::make_unique<EllipticalOrbit>(r, 0.8 * r, 1e-4 * (1.0 + unit(gen)),
+                6.28 * unit(gen), Vec2(0.0, 0.0), 6.28 * unit(gen))
+        ));
+    }
+    return WorldData(bodies, {}, {}, 1e7);
+}
+
+}
+
+int main() {
+    constexpr size_t BODIES = 50, QUERIES = 1024;
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<f64> coord(-1e5, 1e5), mass(1e2, 1e6);
+
+    std::vector<f64> qx(QUERIES), qy(QUERIES), bx(BODIES), by(BODIES), gm(BODIES);
+    for (size_t k = 0; k < QUERIES; ++k) {
+        qx[k] = coord(gen);
+        qy[k] = coord(gen);
+    }
+    for (size_t b = 0; b < BODIES; ++b) {
+        bx[b] = coord(gen);
+        by[b] = coord(gen);
+        gm[b] = mass(gen);
+    }
+    std::vector<f64> ax(QUERIES), ay(QUERIES), phi(QUERIES);
+
+    std::printf("gravity kernel, %zu bodies x %zu queries\n", BODIES, QUERIES);
+    std::printf("%-8s %12s %10s %9s\n", "isa", "us/call", "GFLOP/s", "speedup");
+    double scalar_ns = 0.0;
+    for (auto isa : {simd::Isa::Scalar, simd::Isa::SSE2, simd::Isa::AVX2, simd::Isa::AVX512}) {
+        const auto& kernels = simd::kernels(isa);
+        if (kernels.isa != isa) {
+            continue;
+        }
+        double ns = bench::nsPerCall(256, [&] {
+            kernels.gravity(qx.data(), qy.data(), QUERIES, bx.data(), by.data(), gm.data(), BODIES,
+                MathConfig::epsilon, ax.data(), ay.data(), phi.data());
+            bench::doNotOptimize(ax);
+        });
+        if (isa == simd::Isa::Scalar) {
+            scalar_ns = ns;
+        }
+        std::printf("%-8s %12.2f %10.2f %8.2fx\n", simd::name(isa).data(), ns / 1e3,
+            FLOPS_PER_INTERACTION * BODIES * QUERIES / ns, scalar_ns / ns);
+    }
+
+    auto world = makeWorld(BODIES, gen);
+    {
+        ref::ConcreteEnvironment env(world);
+        std::vector<f64> vxs(QUERIES, 1.0), vys(QUERIES, -1.0), ts(QUERIES, 500.0);
+        std::vector<FieldSample> out(QUERIES);
+        double per_point = bench::nsPerCall(64, [&] {
+            for (size_t k = 0; k < QUERIES; ++k) {
+                out[k] = env.evaluate(Vec2(qx[k], qy[k]), Vec2(vxs[k], vys[k]), ts[k]);
+            }
+            bench::doNotOptimize(out);
+        }) / QUERIES;
+        double batched = bench::nsPerCall(64, [&] {
+            env.evaluateBatch(qx, qy, vxs, vys, ts, out);
+            bench::doNotOptimize(out);
+        }) / QUERIES;
+        std::printf("\n%-24s %10.1f ns/point\n%-24s %10.1f ns/point\n",
+            "evaluate()", per_point, "evaluateBatch()", batched);
+    }
+
+    // 8 directions x 3 thrust levels + a coast, as ThrustActionModel enumerates them.
+    Spacecraft ship(0, 1e3, 500.0, 0.0, {10.0, 50.0, 200.0}, 3.0);
+    std::vector<f64> directions;
+    for (int k = 0; k < 8; ++k) {
+        directions.push_back(k * MathConfig::pi / 4.0);
+    }
+    ref::NaiveWorldIndex index(world);
+    StateVertex from(Vec2(9e3, 7e3), Vec2(-1.5, 2.0), 1234.5, 500.0);
+
+    std::printf("\n%-24s %12s %12s %9s\n", "expansion", "one by one", "lockstep", "speedup");
+    for (f64 quantum : {0.0, 1.0}) {
+        ref::ConcreteEnvironment env(world, quantum);
+        ref::SimpleTimePolicy time_policy(env, 1e9, 60.0);
+        ThrustActionModel one_by_one(env, time_policy, index, world, ship, directions);
+        ThrustActionModel lockstep(
+            env, time_policy, index, world, ship, directions,
+            PropagationConfig(IntegratorKind::RK4, 1e-9, 1e-9, 1000, IntegratorKind::RK4, 1, true)
+        );
+        auto actions = one_by_one.enumerate(from);
+        auto time = [&] (ActionModel& model) {
+            return bench::nsPerCall(64, [&] {
+                model.beginExpansion(from);
+                auto result = model.applyAll(from, actions);
+                bench::doNotOptimize(result);
+            });
+        };
+        double serial = time(one_by_one), batched = time(lockstep);
+        char name[32];
+        std::snprintf(name, sizeof(name), "%zu actions, quantum %.0f", actions.size(), quantum);
+        std::printf("%-24s %10.1f us %10.1f us %8.2fx\n", name, serial / 1e3, batched / 1e3, serial / batched);
+    }
+}
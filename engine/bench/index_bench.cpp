@@ -0,0 +1,146 @@
+/**
+ * Artifact queries of GridWorldIndex against NaiveWorldIndex: 10k artifacts
+ * spread over a 200,000 km square, queried at random points with the
+ * epsilon radius of artifact collection and two wider radii. Then celestial
+ * queries of SweptWorldIndex against NaiveWorldIndex over 1000 bodies, most
+ * of them orbiting at widely different speeds. Each pair of indexes must
+ * return the same entities.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "simulation/index.h"
+
+namespace {
+
+constexpr size_t ARTIFACTS = 10000, QUERIES = 4096;
+constexpr f64 HALF_SIDE = 1e5;          // km
+
+template <typename T>
+std::vector<u32> ids(const shared_vec<T>& entities) {
+    std::vector<u32> result;
+    for (const auto& entity : entities) {
+        result.push_back(entity->id);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * 1000 bodies over the same square: 1/4 stationary, the rest on ellipses
+ * with periods from minutes to months, a few of them behind ephemeris tables.
+ */
+WorldData bodyWorld(std::mt19937_64& gen) {
+    std::uniform_real_distribution<f64> coord(-HALF_SIDE, HALF_SIDE), unit(0.0, 1.0);
+    shared_vec<CelestialBody> bodies;
+    for (u32 i = 0; i < 1000; ++i) {
+        Vec2 center(coord(gen), coord(gen));
+        f64 radius = 10.0 + 40.0 * unit(gen);
+        if (i % 4 == 0) {
+            bodies.push_back(std::make_shared<StationaryBody>(i, radius, 1e20, center));
+            continue;
+        }
+        f64 a = 1e2 + 1e4 * unit(gen);
+        f64 omega = std::pow(10.0, -6.0 - 2.0 * unit(gen) + (i % 16 == 1 ? 4.0 : 0.0));
+        auto orbit = std::make_unique<EllipticalOrbit>(a, (0.5 + 0.5 * unit(gen)) * a, omega,
+            6.28 * unit(gen), center, 6.28 * unit(gen));
+        if (i % 100 == 3) {
+            bodies.push_back(std::make_shared<OrbitingBody>(i, radius, 1e20,
+                std::make_unique<TabulatedTrajectory>(std::move(orbit), 0.0, 0.0, 256)));
+        } else {
+            bodies.push_back(std::make_shared<OrbitingBody>(i, radius, 1e20, std::move(orbit)));
+        }
+    }
+    return WorldData(bodies, {}, {}, 2.0 * HALF_SIDE);
+}
+
+}
+
+int main() {
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<f64> coord(-HALF_SIDE, HALF_SIDE);
+    shared_vec<Artifact> artifacts;
+    for (u32 i = 0; i < ARTIFACTS; ++i) {
+        artifacts.push_back(std::make_shared<Artifact>(i, Vec2(coord(gen), coord(gen))));
+    }
+    // Every tenth query lands on an artifact, as artifactsHere does along a path.
+    std::vector<Vec2> queries(QUERIES);
+    for (size_t k = 0; k < QUERIES; ++k) {
+        queries[k] = (k % 10 == 0) ? artifacts[k % ARTIFACTS]->position : Vec2(coord(gen), coord(gen));
+    }
+
+    WorldData world({}, {}, artifacts, 2.0 * HALF_SIDE);
+    ref::NaiveWorldIndex naive(world);
+    ref::GridWorldIndex grid(world);
+
+    std::printf("%-18s %12s %12s %9s %10s %6s\n", "radius km", "naive us", "grid us", "speedup", "hits/q", "same");
+    for (f64 radius : {MathConfig::epsilon, 1e3, 1e4}) {
+        size_t hits = 0;
+        bool same = true;
+        for (const auto& q : queries) {
+            auto expected = ids(naive.queryArtifacts(q, radius, 0.0f));
+            same = same && expected == ids(grid.queryArtifacts(q, radius, 0.0f));
+            hits += expected.size();
+        }
+
+        auto perQuery = [&] (const WorldIndex& index) {
+            return bench::nsPerCall(4, [&] {
+                size_t found = 0;
+                for (const auto& q : queries) {
+                    index.visitArtifacts(q, radius, 0.0f, [&] (const Artifact&) { ++found; });
+                }
+                bench::doNotOptimize(found);
+            }) / QUERIES;
+        };
+        double naive_ns = perQuery(naive), grid_ns = perQuery(grid);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%g", radius);
+        std::printf("%-18s %12.3f %12.3f %8.1fx %10.1f %6s\n", name, naive_ns / 1e3, grid_ns / 1e3,
+            naive_ns / grid_ns, f64(hits) / QUERIES, same ? "yes" : "NO");
+    }
+
+    constexpr f64 HORIZON = 30.0 * 86400.0;
+    auto bodies = bodyWorld(gen);
+    ref::NaiveWorldIndex naive_bodies(bodies);
+    ref::SweptWorldIndex swept(bodies, HORIZON);
+    std::uniform_real_distribution<f64> time(0.0, HORIZON);
+    std::vector<f64> times(QUERIES);
+    for (auto& t : times) {
+        t = time(gen);
+    }
+
+    std::printf("\n%zu bodies, %zu tiers of swept radii\n", bodies.bodies().size(), swept.tierCount());
+    std::printf("%-18s %12s %12s %9s %10s %6s\n", "radius km", "naive us", "swept us", "speedup", "hits/q", "same");
+    for (f64 radius : {51.0, 2000.0}) {
+        size_t hits = 0;
+        bool same = true;
+        for (size_t k = 0; k < QUERIES; ++k) {
+            auto expected = ids(naive_bodies.queryCelestials(queries[k], radius, times[k]));
+            same = same && expected == ids(swept.queryCelestials(queries[k], radius, times[k]));
+            hits += expected.size();
+        }
+
+        auto perQuery = [&] (const WorldIndex& index) {
+            return bench::nsPerCall(4, [&] {
+                size_t found = 0;
+                for (size_t k = 0; k < QUERIES; ++k) {
+                    index.visitCelestials(queries[k], radius, times[k],
+                        [&] (const CelestialBody&, const Vec2&) { ++found; });
+                }
+                bench::doNotOptimize(found);
+            }) / QUERIES;
+        };
+        double naive_ns = perQuery(naive_bodies), swept_ns = perQuery(swept);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%g", radius);
+        std::printf("%-18s %12.3f %12.3f %8.1fx %10.1f %6s\n", name, naive_ns / 1e3, swept_ns / 1e3,
+            naive_ns / swept_ns, f64(hits) / QUERIES, same ? "yes" : "NO");
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * Norm kernels: the former std::pow-based normp against the specialized
+ * squared-distance, inverse-cube and rsqrt-normalize forms, over random
+ * pairs of points.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "utils/math.h"
+
+namespace {
+
+/**
+ * The former MathConfig::normp, kept here as the baseline.
+ */
+f64 legacyNormp(const Vec2& v, int p = 2) {
+    f64 sum = std::pow(std::fabs(v.x), p) + std::pow(std::fabs(v.y), p);
+    return std::pow(sum, 1.0f / p);
+}
+
+void report(const char* name, double legacy_ns, double fast_ns) {
+    std::printf("%-22s %10.2f %10.2f %8.1fx\n", name, legacy_ns, fast_ns, legacy_ns / fast_ns);
+}
+
+}
+
+int main() {
+    constexpr size_t PAIRS = 1 << 16;
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<f64> coord(-1e5, 1e5);
+    std::vector<Vec2> a(PAIRS), b(PAIRS);
+    for (size_t k = 0; k < PAIRS; ++k) {
+        a[k] = Vec2(coord(gen), coord(gen));
+        b[k] = Vec2(coord(gen), coord(gen));
+    }
+    const f64 radius = 5e4;
+
+    // Each timed call sweeps all pairs; results are reported per pair.
+    auto perPair = [&] (auto&& body) {
+        return bench::nsPerCall(16, [&] {
+            f64 acc = 0.0f;
+            for (size_t k = 0; k < PAIRS; ++k) {
+                acc += body(a[k], b[k]);
+            }
+            bench::doNotOptimize(acc);
+        }) / PAIRS;
+    };
+
+    std::printf("%-22s %10s %10s %9s\n", "kernel (ns/pair)", "legacy", "fast", "speedup");
+
+    report("radius test",
+        perPair([&] (const Vec2& p, const Vec2& q) { return f64(legacyNormp(p - q) <= radius); }),
+        perPair([&] (const Vec2& p, const Vec2& q) { return f64(MathConfig::distSq(p, q) <= radius * radius); })
+    );
+
+    report("gravity inverse cube",
+        perPair([&] (const Vec2& p, const Vec2& q) { return 1.0 / std::pow(legacyNormp(p - q), 3); }),
+        perPair([&] (const Vec2& p, const Vec2& q) {
+            f64 d2 = MathConfig::distSq(p, q);
+            return 1.0 / (d2 * std::sqrt(d2));
+        })
+    );
+
+    report("normalize",
+        perPair([&] (const Vec2& p, const Vec2& q) {
+            auto d = p - q;
+            return (d * (1.0 / legacyNormp(d))).x;
+        }),
+        perPair([&] (const Vec2& p, const Vec2& q) { return MathConfig::normalized(p - q).x; })
+    );
+
+    report("L1 norm",
+        perPair([&] (const Vec2& p, const Vec2& q) { return legacyNormp(p - q, 1); }),
+        perPair([&] (const Vec2& p, const Vec2& q) { return MathConfig::norm<1>(p - q); })
+    );
+}
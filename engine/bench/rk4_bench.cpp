@@ -0,0 +1,117 @@
+/**
+ * Per-step cost of MathConfig::rk4Step (callable template parameter, reused
+ * stage buffers) against the previous std::function-based integrator, which
+ * returned every stage by value.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+#include "bench.h"
+#include "utils/math.h"
+#include "utils/matrix.h"
+
+namespace {
+
+/**
+ * The former MathConfig::rk4Integrate, kept here as the baseline.
+ */
+template <typename T>
+T legacyRk4(const T& x0, f64 t, f64 dt, const std::function<T(const T&, f64)>& f) {
+    T k1 = f(x0, t);
+    T k2 = f(T(x0 + k1 * (dt / 2.0)), t + dt / 2.0);
+    T k3 = f(T(x0 + k2 * (dt / 2.0)), t + dt / 2.0);
+    T k4 = f(T(x0 + k3 * dt), t + dt);
+    return T(x0 + (k1 + k2 * 2.0 + k3 * 2.0 + k4) * (dt / 6.0));
+}
+
+/**
+ * Same layout and operators as ThrustActionModel's integration state.
+ */
+struct ShipState {
+    Vec2 x, v;
+    f64 fuel = 0.0f, t_u = 0.0f;
+
+    ShipState operator+(const ShipState& o) const { return {x + o.x, v + o.v, fuel + o.fuel, t_u + o.t_u}; }
+    ShipState operator*(f64 s) const { return {x * s, v * s, fuel * s, t_u * s}; }
+};
+
+// Ship under one point mass with constant thrust and fuel burn.
+constexpr f64 GM = 3.986e5;
+const Vec2 THRUST(1e-3, 0.0);
+
+inline void shipDerivative(const ShipState& s, f64, ShipState& ds) {
+    f64 d2 = MathConfig::norm2Sq(s.x);
+    ds.x = s.v;
+    ds.v = s.x * (-GM / (d2 * std::sqrt(d2))) + THRUST;
+    ds.fuel = -1e-3;
+    ds.t_u = 1.0;
+}
+
+void report(const char* name, double legacy_ns, double step_ns) {
+    std::printf("%-14s %10.1f %10.1f %8.2fx\n", name, legacy_ns, step_ns, legacy_ns / step_ns);
+}
+
+}
+
+int main() {
+    constexpr size_t ITERATIONS = 1 << 20;
+    constexpr f64 DT = 1e-3;
+    std::printf("%-14s %10s %10s %9s\n", "state", "legacy ns", "rk4Step ns", "speedup");
+
+    {
+        auto f = [] (f64 x, f64 t) { return -0.5 * x + 1e-3 * t; };
+        f64 x = 1.0, t = 0.0;
+        double legacy = bench::nsPerCall(ITERATIONS, [&] {
+            x = legacyRk4<f64>(x, t, DT, f);
+            bench::doNotOptimize(x);
+        });
+        MathConfig::RK4Workspace<f64> ws;
+        x = 1.0;
+        double step = bench::nsPerCall(ITERATIONS, [&] {
+            MathConfig::rk4Step(x, t, DT, [] (f64 s, f64 ts, f64& out) { out = -0.5 * s + 1e-3 * ts; }, ws);
+            bench::doNotOptimize(x);
+        });
+        report("f64", legacy, step);
+    }
+
+    {
+        ShipState s0{Vec2(7000.0, 0.0), Vec2(0.0, 7.5), 100.0, 0.0};
+        auto f = [] (const ShipState& s, f64 t) {
+            ShipState ds;
+            shipDerivative(s, t, ds);
+            return ds;
+        };
+        auto s = s0;
+        double legacy = bench::nsPerCall(ITERATIONS, [&] {
+            s = legacyRk4<ShipState>(s, 0.0, DT, f);
+            bench::doNotOptimize(s);
+        });
+        MathConfig::RK4Workspace<ShipState> ws;
+        s = s0;
+        double step = bench::nsPerCall(ITERATIONS, [&] {
+            MathConfig::rk4Step(s, 0.0, DT, shipDerivative, ws);
+            bench::doNotOptimize(s);
+        });
+        report("ship (Vec2)", legacy, step);
+    }
+
+    {
+        // Heap-backed: 12 elements exceed Matrix's inline storage.
+        Matrix m0(12, 1, 1.0);
+        auto f = [] (const Matrix& m, f64) { return Matrix(m * -0.5); };
+        auto m = m0;
+        double legacy = bench::nsPerCall(ITERATIONS / 8, [&] {
+            m = legacyRk4<Matrix>(m, 0.0, DT, f);
+            bench::doNotOptimize(m);
+        });
+        MathConfig::RK4Workspace<Matrix> ws;
+        m = m0;
+        double step = bench::nsPerCall(ITERATIONS / 8, [&] {
+            MathConfig::rk4Step(m, 0.0, DT, [] (const Matrix& s, f64, Matrix& out) { out = s * -0.5; }, ws);
+            bench::doNotOptimize(m);
+        });
+        report("Matrix 12x1", legacy, step);
+    }
+}
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include "utils/types.h"
 #include "utils/matrix.h"
+#include "utils/math.h"
 
 struct StationaryBodyConfig {
     u32 id;
@@ -50,6 +51,77 @@ struct TimeConfig {
     f64 dt_u;
 };
 
+struct IntegrationConfig {
+    IntegratorKind integrator = IntegratorKind::RK4;
+    f64 rtol = 1e-9;            // adaptive integrators only
+    f64 atol = 1e-9;
+    u32 max_steps = 1000;       // per action
+
+    // Zero-thrust actions: VelocityVerlet or Yoshida4 coast symplectically,
+    // Kepler follows analytic arcs where the environment has them
+    // (EnvironmentKind::PatchedConics); anything else uses 'integrator'.
+    IntegratorKind coast_integrator = IntegratorKind::RK4;
+    u32 coast_substeps = 1;     // per action
+
+    // RK4 only: integrate the thrust actions of one expansion in lockstep,
+    // evaluating the field for all of them per stage. Same states as applying
+    // them one by one; stages whose times share a position_cache_quantum slot
+    // run as one simd batch.
+    bool batch_actions = false;
+};
+
+struct EphemerisConfig {
+    // Replace orbit evaluation by cubic Hermite tables sampled once per
+    // period (or over [0, tmax_u] for aperiodic trajectories).
+    // The tables only serve per-body pos()/vel() calls, e.g. the arcs of
+    // EnvironmentKind::PatchedConics and frame output: about 13 instead of
+    // 24 ns per call for an ellipse, within h^4 / 384 * omega^4 * max(a, b).
+    // The Direct field and the world indexes always evaluate elliptical
+    // orbits in closed form, vectorized across bodies, which beats the
+    // tables; so enable this only when per-body queries dominate.
+    bool tabulate = false;
+    u32 samples = 4096;         // intervals per table
+};
+
+enum class EnvironmentKind {
+    Direct,         // exact O(N) summation
+    BarnesHut,      // quadtree approximation, O(log N)
+    PatchedConics   // dominant body only; pair with IntegratorKind::Kepler coasts
+};
+
+struct EnvironmentConfig {
+    EnvironmentKind kind = EnvironmentKind::Direct;
+    f64 theta = 0.5;            // Barnes-Hut opening angle
+    // BarnesHut: moving bodies are placed at t_u rounded to this slice
+    // (seconds, > 0) and their tree is rebuilt once per slice. Bodies may be
+    // off by speed * slice / 2.
+    f64 barnes_hut_time_slice = 1.0;
+
+    // Direct only: > 0 evaluates body positions at t_u rounded to this
+    // quantum (seconds), memoized per expansion. Bodies may be off by
+    // speed * quantum / 2.
+    f64 position_cache_quantum = 0.0;
+
+    // Direct only: > 0 serves stationary bodies from a precomputed
+    // static_grid_cells^2 grid over [-max_radius, max_radius]^2, exact within
+    // static_grid_near_radii body radii.
+    u32 static_grid_cells = 0;
+    f64 static_grid_near_radii = 4.0;
+};
+
+enum class IndexKind {
+    Naive,          // scans every entity
+    Grid,           // uniform grids over artifacts and wormholes
+    KdTree,         // KD-trees over static entities, with nearest-neighbour queries
+    Swept           // Grid, plus time buckets of swept circles for moving bodies
+};
+
+struct IndexConfig {
+    IndexKind kind = IndexKind::Naive;
+    f64 grid_cell_size = 0.0;   // <= 0 derives it from the entity density
+    f64 swept_bucket_dt = 0.0;  // Swept over [0, tmax_u]; <= 0 uses the finest allowed
+};
+
 struct QuantizationConfig {
     f64 pos_bin;
     f64 vel_bin;
@@ -78,6 +150,10 @@ struct SimulationConfig {
     TimeConfig time_config;
     QuantizationConfig quantization_config;
     SpaceCraftConfig spacecraft_config;
+    IntegrationConfig integration_config;
+    EphemerisConfig ephemeris_config;
+    EnvironmentConfig environment_config;
+    IndexConfig index_config;
 
     StateConfig initial_state;
     u32 k;
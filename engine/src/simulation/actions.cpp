@@ -3,7 +3,7 @@
 // ------------------- StateVertex Definition -------------------
 
 StateVertex::StateVertex(
-    const Matrix& position, const Matrix& velocity,
+    const Vec2& position, const Vec2& velocity,
     f64 t_u, f64 fuel,
     const uset<u32>& collected_artifacts
 ) : x(position),
@@ -26,11 +26,22 @@ ActionModel::ActionModel(
     world_data_(world_data)
 {}
 
+std::vector<std::optional<StateVertex>> ActionModel::applyAll(
+    const StateVertex& from, const shared_vec<Action>& actions
+) {
+    std::vector<std::optional<StateVertex>> result;
+    result.reserve(actions.size());
+    for (const auto& action : actions) {
+        result.push_back(apply(from, action));
+    }
+    return result;
+}
+
 // ------------------- ThrustAction and ThrustActionModel -------------------
 
 ThrustAction::ThrustAction(
     f64 thrust_level, f64 dt_global, 
-    const Matrix& direction
+    const Vec2& direction
 ) : thrust_level(thrust_level),
     direction(direction),
     dt_global(dt_global)
@@ -42,16 +53,18 @@ ThrustActionModel::ThrustActionModel(
     const WorldIndex& world_index,
     const WorldData& world_data,
     const Spacecraft& spacecraft,
-    const std::vector<f64>& possible_directions
+    const std::vector<f64>& possible_directions,
+    const PropagationConfig& propagation
 ) : ActionModel(env_model, time_policy, world_index, world_data),
-    spacecraft_(spacecraft), possible_directions_(possible_directions)
+    spacecraft_(spacecraft), possible_directions_(possible_directions),
+    propagation_(propagation)
 {}
 
-Matrix direction(const StateVertex& from) {
-    auto v = MathConfig::normp(from.v, 2);
-    Matrix forward(2, 1, {1.0f, 0.0f});
+Vec2 direction(const StateVertex& from) {
+    auto v2 = MathConfig::norm2Sq(from.v);
+    Vec2 forward(1.0f, 0.0f);
 
-    if (!MathConfig::floatEquals(v, 0.0f)) {
+    if (v2 >= MathConfig::epsilon * MathConfig::epsilon) {
         forward = MathConfig::normalized(from.v);
     } 
 
@@ -62,11 +75,10 @@ shared_vec<Action> ThrustActionModel::enumerate(
     const StateVertex& from
 ) const {
     shared_vec<Action> actions;
-    Matrix forward = direction(from);
-    Matrix d = Matrix::toHomogeneous(forward);
+    Vec2 forward = direction(from);
 
     for (auto&& angle : possible_directions_) {
-        Matrix dir = Matrix::fromHomogeneous(Matrix::rotate2d(angle) * d);
+        Vec2 dir = Mat3::rotate2d(angle) * forward;
 
         for (auto&& thrust_level : spacecraft_.thrust_levels) {
             auto action = std::make_shared<ThrustAction>(
@@ -78,7 +90,7 @@ shared_vec<Action> ThrustActionModel::enumerate(
     }
 
     auto action = std::make_shared<ThrustAction>(
-        0.0f, time_policy_.dtu(), Matrix::fromHomogeneous(d)
+        0.0f, time_policy_.dtu(), forward
     );
     actions.push_back(action);
 
@@ -91,7 +103,7 @@ bool ThrustActionModel::checkConstraints(
     return !detectCollision(state.x, state.t_u) &&
             (state.isValid()) &&
             (state.t_u <= time_policy_.tmax()) &&
-            (world_data_.max_radius() >= MathConfig::normp(state.x, 2));
+            (world_data_.max_radius() * world_data_.max_radius() >= MathConfig::norm2Sq(state.x));
 
     return true;
 }
@@ -105,13 +117,62 @@ std::optional<StateVertex> ThrustActionModel::apply(
     }
 
     auto s_new = findIntState(from, *ptr);
-    
+    if (!s_new) {
+        return std::nullopt;
+    }
+    return toVertex(from, *s_new);
+}
+
+std::vector<std::optional<StateVertex>> ThrustActionModel::applyAll(
+    const StateVertex& from, const shared_vec<Action>& actions
+) {
+    if (!propagation_.lockstep()) {
+        return ActionModel::applyAll(from, actions);
+    }
+
+    // Symplectic coasts and actions of another duration are applied alone.
+    std::vector<const ThrustAction*> batch;
+    std::vector<const ThrustAction*> ptrs;
+    ptrs.reserve(actions.size());
+    for (const auto& action : actions) {
+        auto ptr = dynamic_cast<const ThrustAction*>(action.get());
+        ptrs.push_back(ptr);
+        if (!ptr || (ptr->thrust_level == 0.0f && propagation_.separateCoast())) {
+            continue;
+        }
+        if (batch.empty() || ptr->dt_global == batch.front()->dt_global) {
+            batch.push_back(ptr);
+        }
+    }
+
+    auto states = integrateBatch(from, batch);
+
+    std::vector<std::optional<StateVertex>> result;
+    result.reserve(actions.size());
+    size_t next = 0;
+    for (size_t k = 0; k < actions.size(); ++k) {
+        if (next < batch.size() && ptrs[k] == batch[next]) {
+            result.push_back(toVertex(from, states[next++]));
+        } else {
+            result.push_back(apply(from, actions[k]));
+        }
+    }
+    return result;
+}
+
+// Helper methods for ThrustActionModel
+
+std::optional<StateVertex> ThrustActionModel::toVertex(
+    const StateVertex& from,
+    const IntState& s_new
+) const {
     auto x         = s_new.x;
     auto v         = s_new.v;
     auto t_u       = s_new.t_u;
     auto fuel      = MathConfig::clamp(s_new.fuel, 0.0f);
-    auto artifacts = from.collected_artifacts | artifactsHere(x, t_u);
-    
+    auto artifacts = from.collected_artifacts;
+    collectArtifactsHere(x, t_u, artifacts);
+
     StateVertex new_state(x, v, t_u, fuel, artifacts);
     if (checkConstraints(new_state)) {
         return new_state;
@@ -120,96 +181,215 @@ std::optional<StateVertex> ThrustActionModel::apply(
     return std::nullopt;
 }
 
-// Helper methods for ThrustActionModel
+void ThrustActionModel::derivative(
+    const IntState& s, const FieldSample& field,
+    const ThrustAction& ptr, IntState& ds
+) const {
+    auto y = field.gamma;                          // dt_u / dτ
+    auto total_mass = spacecraft_.mass + s.fuel;
+    
+    Vec2 a_g = field.acceleration;                 // dv/dt_u
+    Vec2 a_th;                                     // F/m 
+    
+    if (s.fuel > 0.0f) {
+        a_th = ptr.direction * (ptr.thrust_level / total_mass);
+    }
+    
+    ds.x = s.v * y;                                // dx/dτ = v * (dt_u/dτ)
+    ds.v = (a_g + a_th) * y;                       // dv/dτ = (dv/dt_u) (dt_u/dτ)
+    ds.fuel = MathConfig::safeDiv(
+        -ptr.thrust_level, spacecraft_.exhaust_speed, 0.0f
+    );                                             // dfuel/dτ
+    ds.t_u = y;                                    // dt_u/dτ
+}
 
-ThrustActionModel::IntState ThrustActionModel::findIntState(
+std::optional<ThrustActionModel::IntState> ThrustActionModel::findIntState(
     const StateVertex& from,
     const ThrustAction& ptr
 ) const {
+    if (ptr.thrust_level == 0.0f && propagation_.symplecticCoast()) {
+        return coast(from, ptr);
+    }
+    if (ptr.thrust_level == 0.0f && propagation_.keplerCoast()) {
+        // Environments without a closed form fall back to the thrust integrator.
+        if (auto s_new = keplerCoast(from, ptr)) {
+            return s_new;
+        }
+    }
+
     // We will use the RK4 integrator from MathConfig to compute the new state. 
     // there are three ODEs to integrate: position, velocity, and fuel.
     auto deriv = [&] (
         const IntState& s, 
-        f64 /* tau offset. But the system is autonomous */
+        f64 /* tau offset. But the system is autonomous */,
+        IntState& ds
     ) {
-        IntState ds;
-        
-        auto y = env_model_.gamma(s.x, s.v, s.t_u);    // dt_u / dτ
-        auto total_mass = spacecraft_.mass + s.fuel;
-        
-        
-        Matrix a_g = env_model_.gravity(s.x, s.t_u);   // dv/dt_u
-        Matrix a_th = Matrix(2, 1, 0.0f);              // F/m 
-        
-        if (s.fuel > 0.0f) {
-            a_th = ptr.direction * (ptr.thrust_level / total_mass);
-        }
-        
-        ds.x = s.v * y;                                // dx/dτ = v * (dt_u/dτ)
-        ds.v = (a_g + a_th) * y;                       // dv/dτ = (dv/dt_u) (dt_u/dτ)
-        ds.fuel = MathConfig::safeDiv(
-            -ptr.thrust_level, spacecraft_.exhaust_speed, 0.0f
-        );                                             // dfuel/dτ
-        ds.t_u = y;                                    // dt_u/dτ
-        
-        return ds;
+        derivative(s, env_model_.evaluate(s.x, s.v, s.t_u), ptr, ds);
     };
     
     auto dt_prop = time_policy_.toProper(
         ptr.dt_global, from.x, from.v, from.t_u
     );
 
-    IntState s_new = MathConfig::rk4Integrate<IntState>(
-        IntState(from.x, from.v, from.fuel, from.t_u),
-        0.0f,
-        dt_prop,
-        deriv
-    );
+    IntState s_new(from.x, from.v, from.fuel, from.t_u);
+
+    if (propagation_.integrator == IntegratorKind::DormandPrince45) {
+        // Starts with the whole action as one step and subdivides only
+        // where the local error demands it, e.g. close to massive bodies.
+        auto error_ratio = [&] (const IntState& err, const IntState& y0, const IntState& y1) {
+            return IntState::errorRatio(err, y0, y1, propagation_.rtol, propagation_.atol);
+        };
+        MathConfig::DP45Options options{dt_prop, propagation_.max_steps};
+        MathConfig::DP45Workspace<IntState> ws;
+
+        auto stats = MathConfig::dp45Integrate(
+            s_new, 0.0f, dt_prop, deriv, error_ratio, options, ws
+        );
+        if (!stats.completed) {
+            return std::nullopt;
+        }
+        return s_new;
+    }
+
+    MathConfig::RK4Workspace<IntState> ws;
+    MathConfig::rk4Step(s_new, 0.0f, dt_prop, deriv, ws);
     
     return s_new;
 }
 
-const uset<u32> ThrustActionModel::artifactsHere(
-    const Matrix& position,
-    f64 t_u
+std::vector<ThrustActionModel::IntState> ThrustActionModel::integrateBatch(
+    const StateVertex& from,
+    std::span<const ThrustAction* const> batch
 ) const {
-    auto artifacts_here = world_index_.queryArtifacts(
-        position, MathConfig::epsilon, t_u
-    );
-    
-    auto view = artifacts_here | std::views::transform(
-        [] (const std::shared_ptr<Artifact>& artifact) {
-            return artifact->id;
+    size_t n = batch.size();
+    if (n == 0) {
+        return {};
+    }
+
+    thread_local BatchWorkspace ws;
+    for (auto* buffer : {&ws.k1, &ws.k2, &ws.k3, &ws.k4, &ws.tmp}) {
+        buffer->resize(n);
+    }
+    for (auto* buffer : {&ws.xs, &ws.ys, &ws.vxs, &ws.vys, &ws.ts}) {
+        buffer->resize(n);
+    }
+    ws.fields.resize(n);
+
+    // Each state keeps its own stage time, so the batch reproduces the
+    // per-action integration exactly.
+    auto deriv = [&] (const std::vector<IntState>& s, std::vector<IntState>& ds) {
+        for (size_t k = 0; k < n; ++k) {
+            ws.xs[k] = s[k].x.x;
+            ws.ys[k] = s[k].x.y;
+            ws.vxs[k] = s[k].v.x;
+            ws.vys[k] = s[k].v.y;
+            ws.ts[k] = s[k].t_u;
         }
+        env_model_.evaluateBatch(ws.xs, ws.ys, ws.vxs, ws.vys, ws.ts, ws.fields);
+        for (size_t k = 0; k < n; ++k) {
+            derivative(s[k], ws.fields[k], *batch[k], ds[k]);
+        }
+    };
+
+    auto dt_prop = time_policy_.toProper(
+        batch.front()->dt_global, from.x, from.v, from.t_u
     );
 
-    return uset<u32>(view.begin(), view.end());
+    // MathConfig::rk4Step, element-wise over the batch.
+    std::vector<IntState> s_new(n, IntState(from.x, from.v, from.fuel, from.t_u));
+    deriv(s_new, ws.k1);
+    for (size_t k = 0; k < n; ++k) {
+        ws.tmp[k] = s_new[k] + ws.k1[k] * (dt_prop / 2.0);
+    }
+    deriv(ws.tmp, ws.k2);
+    for (size_t k = 0; k < n; ++k) {
+        ws.tmp[k] = s_new[k] + ws.k2[k] * (dt_prop / 2.0);
+    }
+    deriv(ws.tmp, ws.k3);
+    for (size_t k = 0; k < n; ++k) {
+        ws.tmp[k] = s_new[k] + ws.k3[k] * dt_prop;
+    }
+    deriv(ws.tmp, ws.k4);
+    for (size_t k = 0; k < n; ++k) {
+        s_new[k] = s_new[k] + (ws.k1[k] + ws.k2[k] * 2.0 + ws.k3[k] * 2.0 + ws.k4[k]) * (dt_prop / 6.0);
+    }
+
+    return s_new;
 }
 
-bool ThrustActionModel::detectCollision(
-    const Matrix& position,
-    f64 t_u
+ThrustActionModel::IntState ThrustActionModel::coast(
+    const StateVertex& from,
+    const ThrustAction& ptr
 ) const {
-    auto bodies = world_data_.bodies();
-    auto it = std::ranges::max_element(bodies, {}, 
-        [] (const std::shared_ptr<CelestialBody>& body) {
-            return body->radius;
+    auto accel = [&] (const Vec2& x, f64 t_u) {
+        return env_model_.gravity(x, t_u);
+    };
+
+    Vec2 x = from.x, v = from.v;
+    f64 h = ptr.dt_global / propagation_.coast_substeps;
+    f64 t_u = from.t_u;
+
+    if (propagation_.coast_integrator == IntegratorKind::VelocityVerlet) {
+        Vec2 acc = accel(x, t_u);
+        for (u32 i = 0; i < propagation_.coast_substeps; ++i) {
+            MathConfig::velocityVerletStep(x, v, acc, t_u, h, accel);
+            t_u += h;
         }
-    );
+    } else {
+        for (u32 i = 0; i < propagation_.coast_substeps; ++i) {
+            MathConfig::yoshida4Step(x, v, t_u, h, accel);
+            t_u += h;
+        }
+    }
 
-    auto max_radius = (it != bodies.end()) ? (*it)->radius : 0.0f;
+    return IntState(x, v, from.fuel, from.t_u + ptr.dt_global);
+}
 
-    auto nearby_bodies = world_index_.queryCelestials(
-        position, max_radius + 1.0f, t_u
-    );
+std::optional<ThrustActionModel::IntState> ThrustActionModel::keplerCoast(
+    const StateVertex& from,
+    const ThrustAction& ptr
+) const {
+    Vec2 x = from.x, v = from.v;
+    f64 h = ptr.dt_global / propagation_.coast_substeps;
+    f64 t_u = from.t_u;
 
-    for (const auto& body : nearby_bodies) {
-        auto body_pos = body->pos(t_u);
-        auto dist = MathConfig::normp(position - body_pos, 2);
-        if (dist <= body->radius) {
-            return true;
+    for (u32 i = 0; i < propagation_.coast_substeps; ++i) {
+        if (!env_model_.propagateCoast(x, v, t_u, h)) {
+            return std::nullopt;
         }
+        t_u += h;
+    }
+
+    return IntState(x, v, from.fuel, from.t_u + ptr.dt_global);
+}
+
+void ThrustActionModel::collectArtifactsHere(
+    const Vec2& position,
+    f64 t_u,
+    uset<u32>& artifacts
+) const {
+    world_index_.visitArtifacts(
+        position, MathConfig::epsilon, t_u,
+        [&](const Artifact& artifact) { artifacts.insert(artifact.id); }
+    );
+}
+
+bool ThrustActionModel::detectCollision(
+    const Vec2& position,
+    f64 t_u
+) const {
+    if (!world_data_.bodyBounds().contains(position)) {
+        return false;
     }
 
-    return false;
+    bool collided = false;
+    world_index_.visitCelestials(
+        position, world_data_.maxBodyRadius() + 1.0f, t_u,
+        [&](const CelestialBody& body, const Vec2& body_pos) {
+            collided = collided ||
+                MathConfig::distSq(position, body_pos) <= body.radius * body.radius;
+        }
+    );
+
+    return collided;
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include "simulation/world.h"
 #include "utils/types.h"
 #include "utils/matrix.h"
+#include "utils/linalg.h"
 #include "utils/math.h"
 #include "utils/helpers.h"
 
@@ -22,8 +23,8 @@
 // -----------------------------------------------------------------
 
 struct StateVertex {
-    const Matrix x;
-    const Matrix v;
+    const Vec2 x;
+    const Vec2 v;
     const f64 t_u;
     const f64 fuel;
     const uset<u32> collected_artifacts;
@@ -37,13 +38,11 @@ struct StateVertex {
     }
 
     inline bool isValid() const {
-        return (x.rows() == 2 && x.cols() == 1) &&
-               (v.rows() == 2 && v.cols() == 1) &&
-               (fuel >= 0.0f);
+        return (fuel >= 0.0f);
     }
 
     StateVertex(
-        const Matrix& position, const Matrix& velocity,
+        const Vec2& position, const Vec2& velocity,
         f64 t_u, f64 fuel,
         const uset<u32>& collected_artifacts = {}
     );
@@ -56,12 +55,12 @@ template <>
 struct std::hash<StateVertex> {
     inline size_t operator()(const StateVertex& sv) const {
         size_t h = 0;
-        auto mat_hasher = std::hash<Matrix>();
+        auto vec_hasher = std::hash<Vec2>();
         auto flt_hasher = std::hash<f64>();
         auto uint_hasher = std::hash<u32>();
 
-        h = hash_combine(h, mat_hasher(sv.x));
-        h = hash_combine(h, mat_hasher(sv.v));
+        h = hash_combine(h, vec_hasher(sv.x));
+        h = hash_combine(h, vec_hasher(sv.v));
         h = hash_combine(h, flt_hasher(sv.t_u));
         h = hash_combine(h, flt_hasher(sv.fuel));
         for (const auto& artifact_id : sv.collected_artifacts) {
@@ -99,6 +98,23 @@ public:
         const StateVertex& from, std::shared_ptr<Action> action
     ) = 0;
 
+    /**
+     * Applies all actions to 'from'; result k belongs to actions[k].
+     * Lets models share work across the actions of one expansion; the
+     * default applies them one by one.
+     */
+    virtual std::vector<std::optional<StateVertex>> applyAll(
+        const StateVertex& from, const shared_vec<Action>& actions
+    );
+
+    /**
+     * Called once before the actions of 'from' are enumerated and applied.
+     * The default starts a fresh environment cache for the expansion.
+     */
+    inline virtual void beginExpansion(const StateVertex&) {
+        env_model_.resetCache();
+    }
+
 protected:
     const EnvironmentModel& env_model_;
     const TimePolicy& time_policy_;
@@ -108,14 +124,62 @@ protected:
 
 // --------------------- Thrust Actions ---------------------
 
+/**
+ * Selects how ThrustActionModel propagates the ship state over one action.
+ */
+struct PropagationConfig {
+    const IntegratorKind integrator;
+    const f64 rtol;
+    const f64 atol;
+    const u32 max_steps;
+    const IntegratorKind coast_integrator;
+    const u32 coast_substeps;
+    const bool batch_actions;
+
+    inline PropagationConfig(
+        IntegratorKind integrator = IntegratorKind::RK4,
+        f64 rtol = 1e-9, f64 atol = 1e-9,
+        u32 max_steps = 1000,
+        IntegratorKind coast_integrator = IntegratorKind::RK4,
+        u32 coast_substeps = 1,
+        bool batch_actions = false
+    ) : integrator(integrator), rtol(rtol), atol(atol), 
+        max_steps(max_steps), coast_integrator(coast_integrator),
+        coast_substeps(coast_substeps), batch_actions(batch_actions) {
+        req(integrator == IntegratorKind::RK4 || integrator == IntegratorKind::DormandPrince45,
+            "Symplectic and Kepler integrators can only be used for coasting.");
+        req(coast_substeps > 0, "coast_substeps must be positive.");
+    }
+
+    inline bool symplecticCoast() const {
+        return coast_integrator == IntegratorKind::VelocityVerlet ||
+               coast_integrator == IntegratorKind::Yoshida4;
+    }
+
+    inline bool keplerCoast() const {
+        return coast_integrator == IntegratorKind::Kepler;
+    }
+
+    /**
+     * True if zero-thrust actions bypass the thrust integrator.
+     */
+    inline bool separateCoast() const {
+        return symplecticCoast() || keplerCoast();
+    }
+
+    inline bool lockstep() const {
+        return batch_actions && integrator == IntegratorKind::RK4;
+    }
+};
+
 struct ThrustAction : public Action {
     const f64 thrust_level;
-    const Matrix direction; // normalized 2x1 matrix
+    const Vec2 direction; // normalized
     const f64 dt_global;
 
     ThrustAction(
         f64 thrust_level, f64 dt_global, 
-        const Matrix& direction
+        const Vec2& direction
     );
 
     inline f64 cost() const override {
@@ -131,7 +195,8 @@ public:
         const WorldIndex& world_index,
         const WorldData& world_data,
         const Spacecraft& spacecraft,
-        const std::vector<f64>& possible_directions // in radians
+        const std::vector<f64>& possible_directions, // in radians
+        const PropagationConfig& propagation = {}
     );
     
     virtual ~ThrustActionModel() = default;
@@ -144,17 +209,26 @@ public:
         const StateVertex& from, std::shared_ptr<Action> action
     ) override;
 
+    /**
+     * With PropagationConfig::lockstep(), integrates the RK4 thrust actions
+     * together so that each stage evaluates the field in one batch.
+     */
+    virtual std::vector<std::optional<StateVertex>> applyAll(
+        const StateVertex& from, const shared_vec<Action>& actions
+    ) override;
+
 private:
     const Spacecraft& spacecraft_;
     const std::vector<f64> possible_directions_;
+    const PropagationConfig propagation_;
 
 private:
     struct IntState {
-        Matrix x, v;
+        Vec2 x, v;
         f64 fuel, t_u;
 
-        IntState() : x(2, 1), v(2, 1), fuel(0.0f), t_u(0.0f) {}
-        IntState(const Matrix& x, const Matrix& v, f64 fuel, f64 t_u)
+        IntState() : x(), v(), fuel(0.0f), t_u(0.0f) {}
+        IntState(const Vec2& x, const Vec2& v, f64 fuel, f64 t_u)
             : x(x), v(v), fuel(fuel), t_u(t_u) {}
 
         IntState operator+(const IntState& other) const {
@@ -174,20 +248,110 @@ private:
                 t_u * scalar
             };
         }
+
+        IntState operator-(const IntState& other) const {
+            return *this + other * -1.0f;
+        }
+
+        /**
+         * Returns the largest component of err scaled by atol + rtol * |y|.
+         */
+        static inline f64 errorRatio(
+            const IntState& err, const IntState& y0, const IntState& y1,
+            f64 rtol, f64 atol
+        ) {
+            return std::max({
+                MathConfig::scaledError(err.x.x, y0.x.x, y1.x.x, rtol, atol),
+                MathConfig::scaledError(err.x.y, y0.x.y, y1.x.y, rtol, atol),
+                MathConfig::scaledError(err.v.x, y0.v.x, y1.v.x, rtol, atol),
+                MathConfig::scaledError(err.v.y, y0.v.y, y1.v.y, rtol, atol),
+                MathConfig::scaledError(err.fuel, y0.fuel, y1.fuel, rtol, atol),
+                MathConfig::scaledError(err.t_u, y0.t_u, y1.t_u, rtol, atol)
+            });
+        }
+    };
+
+    /**
+     * RK4 stage buffers of a lockstep batch, one IntState per action, and the
+     * field queries of one stage. Kept per thread and reused across expansions.
+     */
+    struct BatchWorkspace {
+        std::vector<IntState> k1, k2, k3, k4, tmp;
+        std::vector<f64> xs, ys, vxs, vys, ts;
+        std::vector<FieldSample> fields;
     };
 
-    IntState findIntState(
+    /**
+     * Writes d/dτ of s into ds, given the field at s and the thrust action.
+     */
+    void derivative(
+        const IntState& s, const FieldSample& field,
+        const ThrustAction& ptr, IntState& ds
+    ) const;
+
+    /**
+     * Integrates the ship state over one action.
+     * Returns std::nullopt if the adaptive integrator runs out of steps.
+     */
+    std::optional<IntState> findIntState(
         const StateVertex& from,
         const ThrustAction& ptr
     ) const;
 
-    const uset<u32> artifactsHere(
-        const Matrix& position,
-        f64 t_u
+    /**
+     * Integrates a zero-thrust action in global time with the configured
+     * symplectic integrator. The field is conservative there, so the
+     * dilation factor cancels out of dx/dt_u and dv/dt_u.
+     */
+    IntState coast(
+        const StateVertex& from,
+        const ThrustAction& ptr
+    ) const;
+
+    /**
+     * Advances a zero-thrust action through EnvironmentModel::propagateCoast,
+     * one call per coast substep. Returns std::nullopt if the environment
+     * has no closed form for it.
+     */
+    std::optional<IntState> keplerCoast(
+        const StateVertex& from,
+        const ThrustAction& ptr
+    ) const;
+
+    /**
+     * Integrates all actions of batch over one RK4 step from 'from', with one
+     * evaluateBatch() call per stage.
+     * Pre: the actions share dt_global.
+     * Post: result k belongs to batch[k] and equals findIntState(from, *batch[k]).
+     */
+    std::vector<IntState> integrateBatch(
+        const StateVertex& from,
+        std::span<const ThrustAction* const> batch
+    ) const;
+
+    /**
+     * Turns an integrated state into the successor of 'from', or std::nullopt
+     * if it violates the constraints.
+     */
+    std::optional<StateVertex> toVertex(
+        const StateVertex& from,
+        const IntState& s_new
+    ) const;
+
+    /**
+     * Adds to artifacts the ids of the artifacts at position.
+     */
+    void collectArtifactsHere(
+        const Vec2& position,
+        f64 t_u,
+        uset<u32>& artifacts
     ) const;
 
+    /**
+     * True iff position lies inside some body at t_u. Allocation-free.
+     */
     bool detectCollision(
-        const Matrix& position,
+        const Vec2& position,
         f64 t_u
     ) const;
 
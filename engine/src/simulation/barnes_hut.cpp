@@ -0,0 +1,235 @@
+#include "barnes_hut.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// ------------------- QuadTree -------------------
+
+void QuadTree::build(
+    std::span<const f64> xs, std::span<const f64> ys, std::span<const f64> masses
+) {
+    req(xs.size() == ys.size() && xs.size() == masses.size(), "QuadTree inputs must have equal sizes.");
+    nodes_.clear();
+    xs_.assign(xs.begin(), xs.end());
+    ys_.assign(ys.begin(), ys.end());
+    ms_.assign(masses.begin(), masses.end());
+    order_.resize(xs.size());
+    scratch_.resize(xs.size());
+    std::iota(order_.begin(), order_.end(), 0u);
+
+    px_.clear();
+    py_.clear();
+    pm_.clear();
+    if (xs.empty()) {
+        return;
+    }
+
+    auto [x_lo, x_hi] = std::ranges::minmax(xs);
+    auto [y_lo, y_hi] = std::ranges::minmax(ys);
+    f64 half = 0.5f * std::max(x_hi - x_lo, y_hi - y_lo) + 1.0f;
+    buildNode(0.5f * (x_lo + x_hi), 0.5f * (y_lo + y_hi), half, 0, static_cast<u32>(xs.size()), 0);
+
+    px_.resize(order_.size());
+    py_.resize(order_.size());
+    pm_.resize(order_.size());
+    for (size_t k = 0; k < order_.size(); ++k) {
+        px_[k] = xs_[order_[k]];
+        py_[k] = ys_[order_[k]];
+        pm_[k] = ms_[order_[k]];
+    }
+}
+
+u32 QuadTree::buildNode(f64 cx, f64 cy, f64 half, u32 begin, u32 end, u32 depth) {
+    u32 index = static_cast<u32>(nodes_.size());
+    nodes_.push_back({cx, cy, half, 0.0f, 0.0f, 0.0f, begin, end, {0, 0, 0, 0}});
+
+    f64 mass = 0.0f, mx = 0.0f, my = 0.0f;
+    for (u32 k = begin; k < end; ++k) {
+        u32 i = order_[k];
+        mass += ms_[i];
+        mx += ms_[i] * xs_[i];
+        my += ms_[i] * ys_[i];
+    }
+    nodes_[index].mass = mass;
+    nodes_[index].mx = mx / mass;
+    nodes_[index].my = my / mass;
+
+    if (end - begin <= LEAF_SIZE || depth >= MAX_DEPTH) {
+        return index;
+    }
+
+    // Quadrants in the order (-x, -y), (+x, -y), (-x, +y), (+x, +y).
+    // A counting sort keeps this branch-free; partitioning random points
+    // mispredicts on every other element.
+    auto quadrant = [&](u32 i) {
+        return static_cast<u32>(xs_[i] >= cx) | (static_cast<u32>(ys_[i] >= cy) << 1);
+    };
+    u32 bounds[5] = {begin, 0, 0, 0, 0};
+    u32 counts[4] = {0, 0, 0, 0};
+    for (u32 k = begin; k < end; ++k) {
+        ++counts[quadrant(order_[k])];
+    }
+    for (u32 c = 0; c < 4; ++c) {
+        bounds[c + 1] = bounds[c] + counts[c];
+    }
+    u32 next[4] = {bounds[0], bounds[1], bounds[2], bounds[3]};
+    for (u32 k = begin; k < end; ++k) {
+        u32 i = order_[k];
+        scratch_[next[quadrant(i)]++] = i;
+    }
+    std::copy(scratch_.begin() + begin, scratch_.begin() + end, order_.begin() + begin);
+
+    f64 q = 0.5f * half;
+    for (u32 c = 0; c < 4; ++c) {
+        if (bounds[c] == bounds[c + 1]) {
+            continue;
+        }
+        f64 ccx = cx + ((c & 1) ? q : -q);
+        f64 ccy = cy + ((c & 2) ? q : -q);
+        u32 child = buildNode(ccx, ccy, q, bounds[c], bounds[c + 1], depth + 1);
+        nodes_[index].child[c] = child;
+    }
+    return index;
+}
+
+void QuadTree::accumulate(const Vec2& p, f64 theta, Vec2& a, f64& phi_sum) const {
+    if (nodes_.empty()) {
+        return;
+    }
+
+    auto add = [&](f64 x, f64 y, f64 m) {
+        Vec2 Ri(x - p.x, y - p.y);
+        auto d2 = MathConfig::norm2Sq(Ri);
+        auto d = std::sqrt(d2);
+        auto gm = MathConfig::G * m;
+        a += Ri * (gm * MathConfig::epsilonDiv(1.0f, d2 * d));
+        phi_sum += MathConfig::epsilonDiv(gm, d);
+    };
+
+    // Depth-first; each level leaves at most 3 siblings behind.
+    std::array<u32, 3 * MAX_DEPTH + 4> stack;
+    size_t top = 0;
+    stack[top++] = 0;
+    f64 theta2 = theta * theta;
+
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        bool leaf = node.child == std::array<u32, 4>{0, 0, 0, 0};
+        if (leaf) {
+            for (u32 k = node.begin; k < node.end; ++k) {
+                add(px_[k], py_[k], pm_[k]);
+            }
+            continue;
+        }
+
+        f64 width = 2.0f * node.half;
+        f64 d2 = MathConfig::distSq(Vec2(node.mx, node.my), p);
+        if (width * width < theta2 * d2) {
+            add(node.mx, node.my, node.mass);
+            continue;
+        }
+        for (u32 child : node.child) {
+            if (child != 0) {
+                stack[top++] = child;
+            }
+        }
+    }
+}
+
+namespace ref {
+
+// ---------------- BarnesHutEnvironment ----------------
+
+BarnesHutEnvironment::BarnesHutEnvironment(
+    const WorldData& world_data, f64 theta, f64 time_slice
+)   : BarnesHutEnvironment::EnvironmentModel(world_data),
+      theta_(theta), time_slice_(time_slice) {
+    req(theta >= 0.0f, "BarnesHutEnvironment theta must be non-negative.");
+    req(time_slice > 0.0f, "BarnesHutEnvironment time slice must be positive.");
+
+    const auto& soa = world_data_.bodySoA();
+    size_t n_st = soa.stationaryCount();
+    std::vector<f64> xs(soa.size()), ys(soa.size());
+    soa.positionsAt(0.0f, xs, ys);
+    static_tree_.build(
+        std::span<const f64>(xs).first(n_st),
+        std::span<const f64>(ys).first(n_st),
+        soa.masses().first(n_st)
+    );
+}
+
+const QuadTree& BarnesHutEnvironment::dynamicTree(f64 t_u) const {
+    auto& cache = cache_.local();
+    f64 slice = std::round(t_u / time_slice_);
+    bool indexable = std::fabs(slice) < MAX_SLICE;
+    i64 key = indexable ? static_cast<i64>(slice) : 0;
+    if (indexable) {
+        if (auto it = cache.trees.find(key); it != cache.trees.end()) {
+            return it->second;
+        }
+        if (cache.trees.size() >= MAX_CACHED_TREES) {
+            resetCache();
+        }
+    }
+
+    const auto& soa = world_data_.bodySoA();
+    size_t n_st = soa.stationaryCount();
+    cache.xs.resize(soa.size());
+    cache.ys.resize(soa.size());
+    soa.positionsAt(indexable ? slice * time_slice_ : t_u, cache.xs, cache.ys);
+
+    auto& tree = indexable ? cache.trees[key] : cache.uncached;
+    tree.build(
+        std::span<const f64>(cache.xs).subspan(n_st),
+        std::span<const f64>(cache.ys).subspan(n_st),
+        soa.masses().subspan(n_st)
+    );
+    ++cache.builds;
+    return tree;
+}
+
+void BarnesHutEnvironment::resetCache() const {
+    cache_.local().trees.clear();
+}
+
+void BarnesHutEnvironment::accumulate(const Vec2& position, f64 t_u, Vec2& a, f64& phi) const {
+    f64 phi_sum = 0.0f;
+    static_tree_.accumulate(position, theta_, a, phi_sum);
+    dynamicTree(t_u).accumulate(position, theta_, a, phi_sum);
+    phi = phi_sum * -1.0f;
+}
+
+Vec2 BarnesHutEnvironment::gravity(const Vec2& position, f64 t_u) const {
+    Vec2 a;
+    f64 phi;
+    accumulate(position, t_u, a, phi);
+    return a;
+}
+
+f64 BarnesHutEnvironment::potential(const Vec2& position, f64 t_u) const {
+    Vec2 a;
+    f64 phi;
+    accumulate(position, t_u, a, phi);
+    return phi;
+}
+
+f64 BarnesHutEnvironment::gamma(const Vec2& position, const Vec2& velocity, f64 t_u) const {
+    return 1.0 / invGamma(position, velocity, t_u);
+}
+
+f64 BarnesHutEnvironment::invGamma(const Vec2& position, const Vec2& velocity, f64 t_u) const {
+    return weakFieldInvGamma(potential(position, t_u), MathConfig::dot(velocity, velocity));
+}
+
+FieldSample BarnesHutEnvironment::evaluate(
+    const Vec2& position, const Vec2& velocity, f64 t_u
+) const {
+    Vec2 a;
+    f64 phi;
+    accumulate(position, t_u, a, phi);
+    auto v2 = MathConfig::dot(velocity, velocity);
+    return {a, phi, 1.0 / weakFieldInvGamma(phi, v2)};
+}
+
+}
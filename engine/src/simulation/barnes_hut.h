@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "utils/types.h"
+#include "utils/math.h"
+#include "utils/linalg.h"
+#include "utils/per_thread.h"
+#include "simulation/world.h"
+
+/**
+ * Barnes-Hut quadtree over point masses.
+ * Every node stores the total mass and centre of mass of the points below it;
+ * leaves hold up to LEAF_SIZE points, which are summed exactly.
+ *
+ * AF: the point masses (px_[k], py_[k], pm_[k]), 0 <= k < px_.size(), stored in
+ *   tree order so that every node covers the contiguous range [begin, end).
+ * Rep-inv:
+ *   nodes_ is empty iff there are no points; otherwise nodes_[0] is the root;
+ *   child index 0 means "no child" (the root is never a child);
+ *   a node is a leaf iff all its children are 0.
+ */
+class QuadTree {
+public:
+    static constexpr u32 LEAF_SIZE = 8;
+    static constexpr u32 MAX_DEPTH = 40;
+
+    QuadTree() = default;
+
+    /**
+     * Rebuilds the tree over the given point masses, reusing storage.
+     * Pre: xs, ys and masses have the same size.
+     */
+    void build(std::span<const f64> xs, std::span<const f64> ys, std::span<const f64> masses);
+
+    /**
+     * Adds the gravitational acceleration at p to a and sum(G m / d) to
+     * phi_sum, approximating a node by its centre of mass when its width is
+     * below theta times its distance. theta == 0 gives the exact sum.
+     */
+    void accumulate(const Vec2& p, f64 theta, Vec2& a, f64& phi_sum) const;
+
+    inline size_t size() const { return px_.size(); }
+    inline size_t nodeCount() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        f64 cx, cy, half;       // square cell
+        f64 mx, my, mass;       // centre of mass and total mass
+        u32 begin, end;         // point range
+        std::array<u32, 4> child;
+    };
+
+    u32 buildNode(f64 cx, f64 cy, f64 half, u32 begin, u32 end, u32 depth);
+
+    std::vector<Node> nodes_;
+    std::vector<u32> order_, scratch_;
+    std::vector<f64> xs_, ys_, ms_;     // input, in caller order
+    std::vector<f64> px_, py_, pm_;     // points in tree order
+};
+
+namespace ref {
+
+/**
+ * Barnes-Hut approximation of ConcreteEnvironment, O(log N) per query.
+ * Stationary bodies go into a tree built once; moving bodies into one tree
+ * per time slice (t_u rounded to a multiple of time_slice), kept until
+ * resetCache() so that all actions of one expansion share the trees of their
+ * RK stage times. Moving bodies are thus off by at most speed * time_slice / 2.
+ * theta is the opening angle: 0 is exact, 0.3-0.7 is typical.
+ * Each thread has its own tree cache, so concurrent queries stay safe.
+ */
+class BarnesHutEnvironment : public ::EnvironmentModel {
+public:
+    /**
+     * Pre: theta >= 0, time_slice > 0. Throws std::runtime_error otherwise.
+     */
+    BarnesHutEnvironment(const WorldData& world_data, f64 theta = 0.5f, f64 time_slice = 1.0f);
+
+    Vec2 gravity(
+        const Vec2& position, f64 t_u
+    ) const override;
+    f64 potential(
+        const Vec2& position, f64 t_u
+    ) const override;
+    f64 gamma(
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const override;
+    f64 invGamma(
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const override;
+    FieldSample evaluate(
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const override;
+
+    /**
+     * Drops the calling thread's trees of moving bodies.
+     */
+    void resetCache() const override;
+
+    /**
+     * Trees of moving bodies built so far on the calling thread.
+     */
+    inline u64 treeBuilds() const { return cache_.local().builds; }
+
+private:
+    /**
+     * Sums the field of both trees at position; phi is the potential.
+     */
+    void accumulate(const Vec2& position, f64 t_u, Vec2& a, f64& phi) const;
+
+    /**
+     * Returns the tree of moving bodies for t_u's time slice, building it on first use.
+     */
+    const QuadTree& dynamicTree(f64 t_u) const;
+
+    // Bounds the tree cache between resets.
+    static constexpr size_t MAX_CACHED_TREES = 64;
+    // |t_u / time_slice_| below this rounds to an i64 slice index.
+    static constexpr f64 MAX_SLICE = 0x1p62;
+
+    const f64 theta_;
+    const f64 time_slice_;
+
+    QuadTree static_tree_;
+
+    // Rep-inv: trees[k] holds the moving bodies at time k * time_slice_;
+    //   uncached is rebuilt for every slice too far out to index.
+    struct TreeCache {
+        umap<i64, QuadTree> trees;
+        QuadTree uncached;
+        std::vector<f64> xs, ys;
+        u64 builds = 0;
+    };
+    PerThread<TreeCache> cache_;
+};
+
+}
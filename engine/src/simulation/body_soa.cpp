@@ -0,0 +1,77 @@
+#include "body_soa.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/simd.h"
+
+BodySoA::BodySoA(
+    std::span<const StationaryBodyData> stationary,
+    std::span<const EllipticalBodyData> elliptical,
+    std::span<const OtherBodyData> other
+) {
+    auto append = [this](const auto& body) {
+        ids_.push_back(body.id);
+        masses_.push_back(body.mass);
+        radii_.push_back(body.radius);
+    };
+
+    for (const auto& body : stationary) {
+        st_x_.push_back(body.position.x);
+        st_y_.push_back(body.position.y);
+        append(body);
+    }
+    for (const auto& body : elliptical) {
+        const auto& orbit = body.orbit;
+        a_.push_back(orbit.a);
+        b_.push_back(orbit.b);
+        omega_.push_back(orbit.omega);
+        phi_.push_back(std::remainder(orbit.phi, 2.0 * MathConfig::pi));
+        period_.push_back(orbit.period());
+        inv_period_.push_back(1.0 / orbit.period());
+        cos_angle_.push_back(orbit.cosAngle());
+        sin_angle_.push_back(orbit.sinAngle());
+        cx_.push_back(orbit.center.x);
+        cy_.push_back(orbit.center.y);
+        append(body);
+    }
+    for (const auto& body : other) {
+        generic_.push_back(body.body);
+        append(body);
+    }
+}
+
+void BodySoA::positionsAt(f64 t, std::span<f64> xs, std::span<f64> ys) const {
+    size_t n_st = st_x_.size();
+    size_t n_el = a_.size();
+
+    std::copy(st_x_.begin(), st_x_.end(), xs.begin());
+    std::copy(st_y_.begin(), st_y_.end(), ys.begin());
+
+    // The elliptical block uses its own output slots as scratch:
+    // phase -> (sin, cos) -> position.
+    f64* ex = xs.data() + n_st;
+    f64* ey = ys.data() + n_st;
+    for (size_t i = 0; i < n_el; ++i) {
+        f64 t_red = t - std::floor(t * inv_period_[i]) * period_[i];
+        if (!(std::fabs(t_red) <= period_[i])) {
+            // The product rounded too coarsely (|t| >> period); fmod is exact.
+            t_red = std::fmod(t, period_[i]);
+        }
+        ex[i] = omega_[i] * t_red + phi_[i];
+    }
+    simd::kernels().sincos(ex, ex, ey, n_el);
+    for (size_t i = 0; i < n_el; ++i) {
+        f64 lx = a_[i] * ey[i];
+        f64 ly = b_[i] * ex[i];
+        ex[i] = cx_[i] + (cos_angle_[i] * lx - sin_angle_[i] * ly);
+        ey[i] = cy_[i] + (sin_angle_[i] * lx + cos_angle_[i] * ly);
+    }
+
+    size_t offset = n_st + n_el;
+    for (size_t i = 0; i < generic_.size(); ++i) {
+        auto p = generic_[i]->pos(t);
+        xs[offset + i] = p.x;
+        ys[offset + i] = p.y;
+    }
+}
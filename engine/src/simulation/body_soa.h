@@ -0,0 +1,74 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "utils/types.h"
+#include "simulation/models.h"
+
+/**
+ * Structure-of-arrays snapshot of the celestial bodies of a world, laid out so
+ * that every body position at one time is evaluated in a single pass.
+ * Bodies are grouped into blocks: stationary bodies, elliptical orbits (whose
+ * phases go through the vectorized simd::Kernels::sincos), then any other
+ * trajectory, evaluated through its virtual pos().
+ *
+ * AF: body k, 0 <= k < size(), has id ids()[k], mass masses()[k] and radius
+ *   radii()[k], and is at (xs[k], ys[k]) after positionsAt(t, xs, ys).
+ */
+class BodySoA {
+public:
+    BodySoA() = default;
+
+    /**
+     * Builds the snapshot from bodies partitioned by kind, in that order.
+     * Pre: the bodies referenced by other outlive the snapshot.
+     */
+    BodySoA(
+        std::span<const StationaryBodyData> stationary,
+        std::span<const EllipticalBodyData> elliptical,
+        std::span<const OtherBodyData> other
+    );
+
+    inline size_t size() const { return ids_.size(); }
+
+    /**
+     * Bodies [0, stationaryCount()) never move.
+     */
+    inline size_t stationaryCount() const { return st_x_.size(); }
+
+    inline std::span<const u32> ids() const { return ids_; }
+    inline std::span<const f64> masses() const { return masses_; }
+    inline std::span<const f64> radii() const { return radii_; }
+
+    /**
+     * Writes the position of every body at time t.
+     * Pre: xs.size() >= size() and ys.size() >= size().
+     * Post: (xs[k], ys[k]) == body(k).pos(t), up to rounding.
+     */
+    void positionsAt(f64 t, std::span<f64> xs, std::span<f64> ys) const;
+
+private:
+    /**
+     * Rep-inv:
+     *   ids_, masses_ and radii_ hold size() entries in block order
+     *   (stationary, elliptical, generic);
+     *   all arrays of one block have the same length, and the block lengths
+     *   add up to size().
+     */
+
+    std::vector<u32> ids_;
+    std::vector<f64> masses_, radii_;
+
+    // stationary block
+    std::vector<f64> st_x_, st_y_;
+
+    // elliptical block; phi_ in [-pi, pi] and t is reduced mod period_, so
+    // phases stay within [-3pi, 3pi], where simd::Kernels::sincos is accurate
+    std::vector<f64> a_, b_, omega_, phi_, period_, inv_period_;
+    std::vector<f64> cos_angle_, sin_angle_;
+    std::vector<f64> cx_, cy_;
+
+    // generic block
+    std::vector<const CelestialBody*> generic_;
+};
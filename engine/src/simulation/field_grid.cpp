@@ -0,0 +1,118 @@
+#include "field_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+StaticFieldGrid::StaticFieldGrid(
+    std::span<const StationaryBodyData> bodies,
+    f64 extent, u32 cells, f64 near_radii
+)   : extent_(extent), cells_(cells), bodies_(bodies.begin(), bodies.end()) {
+    req(extent > 0.0f, "StaticFieldGrid extent must be positive.");
+    req(cells >= 1, "StaticFieldGrid needs at least one cell.");
+    req(near_radii >= 0.0f, "StaticFieldGrid near-field radius must be non-negative.");
+
+    h_ = 2.0f * extent_ / cells_;
+    inv_h_ = 1.0f / h_;
+
+    // phi = -sum G m / d, so phi_x = sum G m dx / d^3 and
+    // phi_xy = -3 sum G m dx dy / d^5, with (dx, dy) = p - body.
+    nodes_.resize(static_cast<size_t>(cells_ + 1) * (cells_ + 1));
+    for (u32 j = 0; j <= cells_; ++j) {
+        for (u32 i = 0; i <= cells_; ++i) {
+            Vec2 p(-extent_ + i * h_, -extent_ + j * h_);
+            Node n{0.0f, 0.0f, 0.0f, 0.0f};
+            for (const auto& body : bodies_) {
+                f64 dx = p.x - body.position.x;
+                f64 dy = p.y - body.position.y;
+                f64 d2 = dx * dx + dy * dy;
+                f64 d = std::sqrt(d2);
+                f64 gm = MathConfig::G * body.mass;
+                f64 inv_d3 = MathConfig::epsilonDiv(1.0f, d2 * d);
+                n.phi -= MathConfig::epsilonDiv(gm, d);
+                n.phi_x += gm * dx * inv_d3;
+                n.phi_y += gm * dy * inv_d3;
+                n.phi_xy -= 3.0f * gm * dx * dy * MathConfig::epsilonDiv(inv_d3, d2);
+            }
+            nodes_[j * (cells_ + 1) + i] = n;
+        }
+    }
+
+    near_.assign(static_cast<size_t>(cells_) * cells_, 0);
+    for (const auto& body : bodies_) {
+        f64 r = near_radii * body.radius;
+        auto cell = [&](f64 v) {
+            return static_cast<i64>(std::floor((v + extent_) * inv_h_));
+        };
+        i64 i0 = std::max<i64>(cell(body.position.x - r), 0);
+        i64 i1 = std::min<i64>(cell(body.position.x + r), cells_ - 1);
+        i64 j0 = std::max<i64>(cell(body.position.y - r), 0);
+        i64 j1 = std::min<i64>(cell(body.position.y + r), cells_ - 1);
+        for (i64 j = j0; j <= j1; ++j) {
+            for (i64 i = i0; i <= i1; ++i) {
+                // Distance from the body to the closest point of the cell.
+                f64 x_lo = -extent_ + i * h_, y_lo = -extent_ + j * h_;
+                f64 qx = std::clamp(body.position.x, x_lo, x_lo + h_);
+                f64 qy = std::clamp(body.position.y, y_lo, y_lo + h_);
+                if (MathConfig::distSq(Vec2(qx, qy), body.position) <= r * r) {
+                    near_[j * cells_ + i] = 1;
+                }
+            }
+        }
+    }
+}
+
+void StaticFieldGrid::accumulateExact(const Vec2& p, Vec2& a, f64& phi) const {
+    for (const auto& body : bodies_) {
+        Vec2 Ri = body.position - p;
+        auto d2 = MathConfig::norm2Sq(Ri);
+        auto d = std::sqrt(d2);
+        auto gm = MathConfig::G * body.mass;
+        a = a + Ri * (gm * MathConfig::epsilonDiv(1.0f, d2 * d));
+        phi -= MathConfig::epsilonDiv(gm, d);
+    }
+}
+
+void StaticFieldGrid::accumulate(const Vec2& p, Vec2& a, f64& phi) const {
+    f64 gx = (p.x + extent_) * inv_h_;
+    f64 gy = (p.y + extent_) * inv_h_;
+    if (!(gx >= 0.0f && gx <= cells_ && gy >= 0.0f && gy <= cells_)) {
+        accumulateExact(p, a, phi);
+        return;
+    }
+    u32 i = std::min(static_cast<u32>(gx), cells_ - 1);
+    u32 j = std::min(static_cast<u32>(gy), cells_ - 1);
+    if (near_[j * cells_ + i]) {
+        accumulateExact(p, a, phi);
+        return;
+    }
+
+    // Cubic Hermite basis in u and v, and its derivatives.
+    f64 u = gx - i, v = gy - j;
+    auto basis = [](f64 s, f64 b[4], f64 db[4]) {
+        f64 s2 = s * s, s3 = s2 * s;
+        b[0] = 2.0f * s3 - 3.0f * s2 + 1.0f;    db[0] = 6.0f * s2 - 6.0f * s;
+        b[1] = -2.0f * s3 + 3.0f * s2;          db[1] = -6.0f * s2 + 6.0f * s;
+        b[2] = s3 - 2.0f * s2 + s;              db[2] = 3.0f * s2 - 4.0f * s + 1.0f;
+        b[3] = s3 - s2;                         db[3] = 3.0f * s2 - 2.0f * s;
+    };
+    f64 bu[4], dbu[4], bv[4], dbv[4];
+    basis(u, bu, dbu);
+    basis(v, bv, dbv);
+
+    f64 value = 0.0f, du = 0.0f, dv = 0.0f;
+    for (u32 cj = 0; cj < 2; ++cj) {
+        for (u32 ci = 0; ci < 2; ++ci) {
+            const Node& n = node(i + ci, j + cj);
+            // Values and derivatives in cell units (d/du = h d/dx).
+            f64 terms[4] = {n.phi, h_ * n.phi_x, h_ * n.phi_y, h_ * h_ * n.phi_xy};
+            f64 U = bu[ci], dU = dbu[ci], U1 = bu[2 + ci], dU1 = dbu[2 + ci];
+            f64 V = bv[cj], dV = dbv[cj], V1 = bv[2 + cj], dV1 = dbv[2 + cj];
+            value += terms[0] * U * V  + terms[1] * U1 * V  + terms[2] * U * V1  + terms[3] * U1 * V1;
+            du    += terms[0] * dU * V + terms[1] * dU1 * V + terms[2] * dU * V1 + terms[3] * dU1 * V1;
+            dv    += terms[0] * U * dV + terms[1] * U1 * dV + terms[2] * U * dV1 + terms[3] * U1 * dV1;
+        }
+    }
+
+    phi += value;
+    a = a - Vec2(du, dv) * inv_h_;
+}
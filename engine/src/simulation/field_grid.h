@@ -0,0 +1,62 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "utils/types.h"
+#include "utils/math.h"
+#include "utils/linalg.h"
+#include "simulation/models.h"
+
+/**
+ * Precomputed field of the stationary bodies over [-extent, extent]^2.
+ * Stores the potential and its first and mixed derivatives at the nodes of a
+ * cells x cells grid and interpolates the potential bicubically (Hermite) in
+ * each cell; the acceleration is minus the gradient of that interpolant, so
+ * the two stay consistent. Cells within near_radii body radii of a body, and
+ * points outside the grid, fall back to exact summation.
+ * Immutable after construction, so safe for concurrent queries.
+ *
+ * Rep-inv:
+ *   h_ == 2 * extent_ / cells_; nodes_.size() == (cells_ + 1)^2;
+ *   near_.size() == cells_^2;
+ *   near_[j * cells_ + i] iff cell (i, j) lies within near_radii radii of a body.
+ */
+class StaticFieldGrid {
+public:
+    /**
+     * Pre: extent > 0; cells >= 1; near_radii >= 0.
+     */
+    StaticFieldGrid(
+        std::span<const StationaryBodyData> bodies,
+        f64 extent, u32 cells, f64 near_radii
+    );
+
+    /**
+     * Adds the acceleration of the stationary bodies at p to a and their
+     * potential to phi.
+     */
+    void accumulate(const Vec2& p, Vec2& a, f64& phi) const;
+
+    /**
+     * Adds the exact acceleration and potential, as ConcreteEnvironment sums them.
+     */
+    void accumulateExact(const Vec2& p, Vec2& a, f64& phi) const;
+
+    inline u32 cells() const { return cells_; }
+
+private:
+    struct Node {
+        f64 phi, phi_x, phi_y, phi_xy;
+    };
+
+    inline const Node& node(u32 i, u32 j) const { return nodes_[j * (cells_ + 1) + i]; }
+
+    f64 extent_;
+    u32 cells_;
+    f64 h_, inv_h_;
+
+    std::vector<Node> nodes_;
+    std::vector<byte> near_;
+    std::vector<StationaryBodyData> bodies_;
+};
@@ -0,0 +1,485 @@
+#include "index.h"
+
+#include <numeric>
+
+// ------------------- PointGrid -------------------
+
+PointGrid::PointGrid(std::span<const Vec2> points, f64 max_radius, f64 cell_size) {
+    if (points.empty()) {
+        return;
+    }
+
+    f64 x_lo = MathConfig::infinity, y_lo = MathConfig::infinity;
+    f64 x_hi = -MathConfig::infinity, y_hi = -MathConfig::infinity;
+    for (const auto& p : points) {
+        x_lo = std::min(x_lo, p.x);
+        x_hi = std::max(x_hi, p.x);
+        y_lo = std::min(y_lo, p.y);
+        y_hi = std::max(y_hi, p.y);
+    }
+    if (max_radius > 0.0f) {
+        x_lo = std::max(x_lo, -max_radius);
+        y_lo = std::max(y_lo, -max_radius);
+        x_hi = std::max(std::min(x_hi, max_radius), x_lo);
+        y_hi = std::max(std::min(y_hi, max_radius), y_lo);
+    }
+    f64 width = std::max(x_hi - x_lo, MathConfig::epsilon);
+    f64 height = std::max(y_hi - y_lo, MathConfig::epsilon);
+
+    if (cell_size <= 0.0f) {
+        cell_size = std::sqrt(width * height * TARGET_PER_CELL / points.size());
+    }
+    // Degenerate boxes (collinear points) give tiny cells; cap the grid instead.
+    cell_size = std::max({cell_size, width / MAX_CELLS_PER_SIDE, height / MAX_CELLS_PER_SIDE});
+
+    x0_ = x_lo;
+    y0_ = y_lo;
+    cell_ = cell_size;
+    inv_cell_ = 1.0 / cell_size;
+    nx_ = static_cast<u32>(std::clamp(std::ceil(width * inv_cell_), 1.0, static_cast<f64>(MAX_CELLS_PER_SIDE)));
+    ny_ = static_cast<u32>(std::clamp(std::ceil(height * inv_cell_), 1.0, static_cast<f64>(MAX_CELLS_PER_SIDE)));
+
+    // Counting sort of the points by cell.
+    std::vector<u32> cell_of(points.size());
+    cell_start_.assign(static_cast<size_t>(nx_) * ny_ + 1, 0);
+    for (size_t k = 0; k < points.size(); ++k) {
+        cell_of[k] = cellY(points[k].y) * nx_ + cellX(points[k].x);
+        ++cell_start_[cell_of[k] + 1];
+    }
+    for (size_t c = 1; c < cell_start_.size(); ++c) {
+        cell_start_[c] += cell_start_[c - 1];
+    }
+
+    std::vector<u32> next(cell_start_.begin(), cell_start_.end() - 1);
+    ids_.resize(points.size());
+    xs_.resize(points.size());
+    ys_.resize(points.size());
+    for (size_t k = 0; k < points.size(); ++k) {
+        u32 j = next[cell_of[k]]++;
+        ids_[j] = static_cast<u32>(k);
+        xs_[j] = points[k].x;
+        ys_[j] = points[k].y;
+    }
+}
+
+// ------------------- KdTree -------------------
+
+KdTree::KdTree(std::span<const Vec2> points, std::span<const u32> keys) {
+    req(keys.empty() || keys.size() == points.size(), "KdTree keys must match the points.");
+    if (points.empty()) {
+        return;
+    }
+
+    index_.resize(points.size());
+    std::iota(index_.begin(), index_.end(), 0u);
+    buildNode(0, static_cast<u32>(points.size()), 0, points);
+
+    xs_.resize(points.size());
+    ys_.resize(points.size());
+    key_.resize(points.size());
+    for (size_t j = 0; j < index_.size(); ++j) {
+        xs_[j] = points[index_[j]].x;
+        ys_[j] = points[index_[j]].y;
+        key_[j] = keys.empty() ? index_[j] : keys[index_[j]];
+    }
+}
+
+u32 KdTree::buildNode(u32 begin, u32 end, u32 depth, std::span<const Vec2> points) {
+    u32 n = static_cast<u32>(nodes_.size());
+    Node node{
+        MathConfig::infinity, MathConfig::infinity,
+        -MathConfig::infinity, -MathConfig::infinity,
+        begin, end, 0
+    };
+    for (u32 j = begin; j < end; ++j) {
+        const auto& p = points[index_[j]];
+        node.x_lo = std::min(node.x_lo, p.x);
+        node.y_lo = std::min(node.y_lo, p.y);
+        node.x_hi = std::max(node.x_hi, p.x);
+        node.y_hi = std::max(node.y_hi, p.y);
+    }
+    nodes_.push_back(node);
+
+    if (end - begin <= LEAF_SIZE || depth >= MAX_DEPTH) {
+        return n;
+    }
+
+    bool split_x = node.x_hi - node.x_lo >= node.y_hi - node.y_lo;
+    u32 mid = begin + (end - begin) / 2;
+    std::nth_element(
+        index_.begin() + begin, index_.begin() + mid, index_.begin() + end,
+        [&](u32 a, u32 b) {
+            return split_x ? points[a].x < points[b].x : points[a].y < points[b].y;
+        }
+    );
+
+    buildNode(begin, mid, depth + 1, points);
+    u32 right = buildNode(mid, end, depth + 1, points);
+    nodes_[n].right = right;
+    return n;
+}
+
+namespace ref {
+
+// ------------------- GridWorldIndex -------------------
+
+namespace {
+
+template <typename T, typename Key>
+std::vector<Vec2> keyPoints(const shared_vec<T>& entities, Key&& key) {
+    std::vector<Vec2> points;
+    points.reserve(entities.size());
+    for (const auto& e : entities) {
+        points.push_back(key(*e));
+    }
+    return points;
+}
+
+}
+
+GridWorldIndex::GridWorldIndex(const WorldData& world_data, f64 cell_size)
+    : GridWorldIndex::NaiveWorldIndex(world_data),
+      wormhole_grid_(
+          keyPoints(world_data.wormholes(), [] (const WormHole& wh) { return wh.entry; }),
+          world_data.max_radius(), cell_size
+      ),
+      artifact_grid_(
+          keyPoints(world_data.artifacts(), [] (const Artifact& art) { return art.position; }),
+          world_data.max_radius(), cell_size
+      ) {}
+
+const shared_vec<WormHole> GridWorldIndex::queryWormHoles(
+    const Vec2& position, f64 radius, f64
+) const {
+    shared_vec<WormHole> result;
+    const auto& wormholes = world_data_.wormholes();
+    wormhole_grid_.forEachWithin(position, radius, [&](u32 k) {
+        result.push_back(wormholes[k]);
+    });
+    return result;
+}
+
+const shared_vec<Artifact> GridWorldIndex::queryArtifacts(
+    const Vec2& position, f64 radius, f64
+) const {
+    shared_vec<Artifact> result;
+    const auto& artifacts = world_data_.artifacts();
+    artifact_grid_.forEachWithin(position, radius, [&](u32 k) {
+        result.push_back(artifacts[k]);
+    });
+    return result;
+}
+
+void GridWorldIndex::visitWormHoles(
+    const Vec2& position, f64 radius, f64,
+    FunctionRef<void(const WormHole&)> visit
+) const {
+    const auto& wormholes = world_data_.wormholes();
+    wormhole_grid_.forEachWithin(position, radius, [&](u32 k) {
+        visit(*wormholes[k]);
+    });
+}
+
+void GridWorldIndex::visitArtifacts(
+    const Vec2& position, f64 radius, f64,
+    FunctionRef<void(const Artifact&)> visit
+) const {
+    const auto& artifacts = world_data_.artifacts();
+    artifact_grid_.forEachWithin(position, radius, [&](u32 k) {
+        visit(*artifacts[k]);
+    });
+}
+
+// ------------------- SweptWorldIndex -------------------
+
+SweptWorldIndex::SweptWorldIndex(
+    const WorldData& world_data, f64 horizon, f64 bucket_dt, f64 cell_size
+) : SweptWorldIndex::GridWorldIndex(world_data, cell_size) {
+    req(horizon >= 0.0f, "SweptWorldIndex horizon must be non-negative.");
+
+    std::vector<Vec2> points;
+    for (const auto& body : world_data_.stationaryBodies()) {
+        points.push_back(body.position);
+    }
+    static_grid_ = PointGrid(points, world_data_.max_radius(), cell_size);
+
+    // Without buckets, queries scan the elliptical bodies.
+    auto elliptical = world_data_.ellipticalBodies();
+    if (elliptical.empty() || horizon <= 0.0f) {
+        return;
+    }
+
+    size_t max_buckets = std::clamp<size_t>(MAX_ENTRIES / elliptical.size(), 1, MAX_BUCKETS);
+    bucket_dt_ = std::max(bucket_dt, horizon / max_buckets);
+    bucket_count_ = std::min(static_cast<size_t>(std::ceil(horizon / bucket_dt_)), max_buckets);
+
+    // |pos(t) - pos(t_mid)| is bounded by both the arc, at speed at most
+    // omega * max(a, b), and the ellipse's diameter.
+    std::vector<f64> swept;
+    for (const auto& body : elliptical) {
+        const auto& orbit = body.orbit;
+        f64 extent = std::max(orbit.a, orbit.b);
+        swept.push_back(
+            std::min(0.5 * orbit.omega * extent * bucket_dt_, 2.0 * extent) +
+            ROUNDING_SLACK * (MathConfig::norm<2>(orbit.center) + extent)
+        );
+    }
+
+    f64 largest = *std::ranges::max_element(swept);
+    tiers_.resize(MAX_TIERS);
+    for (u32 k = 0; k < elliptical.size(); ++k) {
+        f64 tier = std::floor(std::log2(largest / swept[k]));
+        auto& t = tiers_[static_cast<size_t>(std::clamp(tier, 0.0, MAX_TIERS - 1.0))];
+        t.moving.push_back(k);
+        t.swept_radius = std::max(t.swept_radius, swept[k]);
+    }
+    std::erase_if(tiers_, [](const Tier& t) { return t.moving.empty(); });
+
+    for (auto& tier : tiers_) {
+        tier.buckets.reserve(bucket_count_);
+        for (size_t b = 0; b < bucket_count_; ++b) {
+            f64 t_mid = (b + 0.5) * bucket_dt_;
+            points.clear();
+            for (auto k : tier.moving) {
+                points.push_back(elliptical[k].pos(t_mid));
+            }
+            tier.buckets.emplace_back(points, world_data_.max_radius(), cell_size);
+        }
+    }
+}
+
+template <typename Visitor>
+void SweptWorldIndex::forEachCelestial(
+    const Vec2& position, f64 radius, f64 t_u, Visitor&& visit
+) const {
+    auto stationary = world_data_.stationaryBodies();
+    static_grid_.forEachWithin(position, radius, [&](u32 k) {
+        visit(stationary[k].index, stationary[k].position);
+    });
+
+    f64 radius2 = radius * radius;
+    auto narrow = [&](const auto& body) {
+        auto body_pos = body.pos(t_u);
+        if (MathConfig::distSq(body_pos, position) <= radius2) {
+            visit(body.index, body_pos);
+        }
+    };
+
+    auto elliptical = world_data_.ellipticalBodies();
+    f64 b = std::floor(t_u / bucket_dt_);
+    bool bucketed = b >= 0.0f && b < static_cast<f64>(bucket_count_);
+    if (!bucketed) {
+        for (const auto& body : elliptical) {
+            narrow(body);
+        }
+    } else {
+        // Broad phase: swept circles reaching the query disc, found by their centres.
+        for (const auto& tier : tiers_) {
+            tier.buckets[static_cast<size_t>(b)].forEachWithin(
+                position, radius + tier.swept_radius,
+                [&](u32 i) { narrow(elliptical[tier.moving[i]]); }
+            );
+        }
+    }
+    // No speed bound: always scanned.
+    for (const auto& body : world_data_.otherBodies()) {
+        narrow(body);
+    }
+}
+
+const shared_vec<CelestialBody> SweptWorldIndex::queryCelestials(
+    const Vec2& position, f64 radius, f64 t_u
+) const {
+    shared_vec<CelestialBody> result;
+    const auto& bodies = world_data_.bodies();
+    forEachCelestial(position, radius, t_u, [&](u32 slot, const Vec2&) {
+        result.push_back(bodies[slot]);
+    });
+    return result;
+}
+
+void SweptWorldIndex::visitCelestials(
+    const Vec2& position, f64 radius, f64 t_u,
+    FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+) const {
+    const auto& bodies = world_data_.bodies();
+    forEachCelestial(position, radius, t_u, [&](u32 slot, const Vec2& body_pos) {
+        visit(*bodies[slot], body_pos);
+    });
+}
+
+// ------------------- KdTreeWorldIndex -------------------
+
+namespace {
+
+template <typename T, typename Key>
+std::vector<u32> entityIds(const T& entities, Key&& key) {
+    std::vector<u32> ids;
+    ids.reserve(entities.size());
+    for (const auto& e : entities) {
+        ids.push_back(key(e));
+    }
+    return ids;
+}
+
+}
+
+KdTreeWorldIndex::KdTreeWorldIndex(const WorldData& world_data)
+    : KdTreeWorldIndex::WorldIndex(world_data) {
+    auto stationary = world_data_.stationaryBodies();
+    std::vector<Vec2> points;
+    for (const auto& body : stationary) {
+        points.push_back(body.position);
+    }
+    static_bodies_ = KdTree(points, entityIds(stationary, [] (const auto& b) { return b.id; }));
+
+    const auto& wormholes = world_data_.wormholes();
+    wormholes_ = KdTree(
+        keyPoints(wormholes, [] (const WormHole& wh) { return wh.entry; }),
+        entityIds(wormholes, [] (const auto& wh) { return wh->id; })
+    );
+
+    const auto& artifacts = world_data_.artifacts();
+    artifacts_ = KdTree(
+        keyPoints(artifacts, [] (const Artifact& art) { return art.position; }),
+        entityIds(artifacts, [] (const auto& art) { return art->id; })
+    );
+}
+
+template <typename Visitor>
+void KdTreeWorldIndex::forEachCelestial(
+    const Vec2& position, f64 radius, f64 t_u, Visitor&& visit
+) const {
+    auto stationary = world_data_.stationaryBodies();
+    static_bodies_.forEachWithin(position, radius, [&](u32 k) {
+        visit(stationary[k].index, stationary[k].position);
+    });
+
+    f64 radius2 = radius * radius;
+    auto scan = [&](const auto& moving) {
+        for (const auto& body : moving) {
+            auto body_pos = body.pos(t_u);
+            if (MathConfig::distSq(body_pos, position) <= radius2) {
+                visit(body.index, body_pos);
+            }
+        }
+    };
+    scan(world_data_.ellipticalBodies());
+    scan(world_data_.otherBodies());
+}
+
+const shared_vec<CelestialBody> KdTreeWorldIndex::queryCelestials(
+    const Vec2& position, f64 radius, f64 t_u
+) const {
+    shared_vec<CelestialBody> result;
+    const auto& bodies = world_data_.bodies();
+    forEachCelestial(position, radius, t_u, [&](u32 slot, const Vec2&) {
+        result.push_back(bodies[slot]);
+    });
+    return result;
+}
+
+void KdTreeWorldIndex::visitCelestials(
+    const Vec2& position, f64 radius, f64 t_u,
+    FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+) const {
+    const auto& bodies = world_data_.bodies();
+    forEachCelestial(position, radius, t_u, [&](u32 slot, const Vec2& body_pos) {
+        visit(*bodies[slot], body_pos);
+    });
+}
+
+const shared_vec<WormHole> KdTreeWorldIndex::queryWormHoles(
+    const Vec2& position, f64 radius, f64
+) const {
+    shared_vec<WormHole> result;
+    const auto& wormholes = world_data_.wormholes();
+    wormholes_.forEachWithin(position, radius, [&](u32 k) {
+        result.push_back(wormholes[k]);
+    });
+    return result;
+}
+
+const shared_vec<Artifact> KdTreeWorldIndex::queryArtifacts(
+    const Vec2& position, f64 radius, f64
+) const {
+    shared_vec<Artifact> result;
+    const auto& artifacts = world_data_.artifacts();
+    artifacts_.forEachWithin(position, radius, [&](u32 k) {
+        result.push_back(artifacts[k]);
+    });
+    return result;
+}
+
+void KdTreeWorldIndex::visitWormHoles(
+    const Vec2& position, f64 radius, f64,
+    FunctionRef<void(const WormHole&)> visit
+) const {
+    const auto& wormholes = world_data_.wormholes();
+    wormholes_.forEachWithin(position, radius, [&](u32 k) {
+        visit(*wormholes[k]);
+    });
+}
+
+void KdTreeWorldIndex::visitArtifacts(
+    const Vec2& position, f64 radius, f64,
+    FunctionRef<void(const Artifact&)> visit
+) const {
+    const auto& artifacts = world_data_.artifacts();
+    artifacts_.forEachWithin(position, radius, [&](u32 k) {
+        visit(*artifacts[k]);
+    });
+}
+
+std::vector<Neighbor> KdTreeWorldIndex::kNearest(
+    const Vec2& position, size_t k, f64 t_u, const QueryFilter& filter
+) const {
+    std::vector<KdTree::Candidate> heap;
+    heap.reserve(k);
+    f64 max_d2 = filter.max_distance * filter.max_distance;
+
+    switch (filter.kind) {
+        case EntityKind::Celestial: {
+            // Moving bodies seed the heap, which then bounds the tree search.
+            auto offer = [&](const auto& moving) {
+                for (const auto& body : moving) {
+                    if (filter.admits(body.id)) {
+                        auto d2 = MathConfig::distSq(body.pos(t_u), position);
+                        KdTree::offer(heap, k, max_d2, {d2, body.id, 0});
+                    }
+                }
+            };
+            offer(world_data_.ellipticalBodies());
+            offer(world_data_.otherBodies());
+            auto stationary = world_data_.stationaryBodies();
+            static_bodies_.search(position, k, max_d2, [&](u32 i) {
+                return filter.admits(stationary[i].id);
+            }, heap);
+            break;
+        }
+        case EntityKind::WormHole: {
+            const auto& wormholes = world_data_.wormholes();
+            wormholes_.search(position, k, max_d2, [&](u32 i) {
+                return filter.admits(wormholes[i]->id);
+            }, heap);
+            break;
+        }
+        case EntityKind::Artifact: {
+            const auto& artifacts = world_data_.artifacts();
+            artifacts_.search(position, k, max_d2, [&](u32 i) {
+                return filter.admits(artifacts[i]->id);
+            }, heap);
+            break;
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    std::vector<Neighbor> result;
+    result.reserve(heap.size());
+    for (const auto& c : heap) {
+        result.push_back({c.key, std::sqrt(c.d2)});
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "utils/types.h"
+#include "utils/math.h"
+#include "utils/linalg.h"
+#include "simulation/world.h"
+
+/**
+ * Uniform grid over a fixed point set, stored in compressed rows: the points
+ * of cell c are entries [cell_start_[c], cell_start_[c + 1]) of ids_, xs_ and
+ * ys_. Cells cover the bounding box of the points clipped to
+ * [-max_radius, max_radius]^2; the border cells extend to infinity, so points
+ * and queries outside the box are still handled exactly.
+ *
+ * AF: point k, 0 <= k < size(), is at (xs_[j], ys_[j]) where ids_[j] == k.
+ * Rep-inv: cell_start_ has nx_ * ny_ + 1 non-decreasing entries, the last
+ *   being size(); every point lies in the (clamped) cell that holds it.
+ */
+class PointGrid {
+public:
+    // Expected points per cell when the cell size is derived.
+    static constexpr f64 TARGET_PER_CELL = 2.0;
+    static constexpr u32 MAX_CELLS_PER_SIDE = 2048;
+
+    PointGrid() = default;
+
+    /**
+     * Buckets the points. cell_size <= 0 derives it from the density of the
+     * points, aiming at TARGET_PER_CELL points per cell.
+     */
+    PointGrid(std::span<const Vec2> points, f64 max_radius, f64 cell_size = 0.0f);
+
+    inline size_t size() const { return ids_.size(); }
+    inline f64 cellSize() const { return cell_; }
+
+    /**
+     * Calls visit(k) for every point k within radius of p, in cell order.
+     */
+    template <typename Visitor>
+    inline void forEachWithin(const Vec2& p, f64 radius, Visitor&& visit) const {
+        if (ids_.empty()) {
+            return;
+        }
+        u32 cx0 = cellX(p.x - radius), cx1 = cellX(p.x + radius);
+        u32 cy0 = cellY(p.y - radius), cy1 = cellY(p.y + radius);
+        f64 radius2 = radius * radius;
+
+        for (u32 cy = cy0; cy <= cy1; ++cy) {
+            // Cells of one row are contiguous, so the row is a single range.
+            u32 begin = cell_start_[cy * nx_ + cx0];
+            u32 end = cell_start_[cy * nx_ + cx1 + 1];
+            for (u32 j = begin; j < end; ++j) {
+                f64 dx = xs_[j] - p.x, dy = ys_[j] - p.y;
+                if (dx * dx + dy * dy <= radius2) {
+                    visit(ids_[j]);
+                }
+            }
+        }
+    }
+
+private:
+    inline u32 cellX(f64 x) const {
+        f64 c = std::floor((x - x0_) * inv_cell_);
+        return static_cast<u32>(std::clamp(c, 0.0, static_cast<f64>(nx_ - 1)));
+    }
+
+    inline u32 cellY(f64 y) const {
+        f64 c = std::floor((y - y0_) * inv_cell_);
+        return static_cast<u32>(std::clamp(c, 0.0, static_cast<f64>(ny_ - 1)));
+    }
+
+    f64 x0_ = 0.0f, y0_ = 0.0f;
+    f64 cell_ = 1.0f, inv_cell_ = 1.0f;
+    u32 nx_ = 1, ny_ = 1;
+
+    std::vector<u32> cell_start_;
+    std::vector<u32> ids_;
+    std::vector<f64> xs_, ys_;
+};
+
+/**
+ * Static 2-d tree over a fixed point set. Every node splits its points at the
+ * median along the wider side of its bounding box, down to LEAF_SIZE points.
+ * Each point carries its position k in the input and a caller-chosen key
+ * (e.g. an entity id), which breaks distance ties in nearest-neighbour search.
+ *
+ * AF: point j of the tree order is (xs_[j], ys_[j]), input index_[j], key key_[j].
+ * Rep-inv: nodes_ is empty iff there are no points, else nodes_[0] is the
+ *   root; an inner node's left child directly follows it; every node's box
+ *   bounds the points [begin, end) it covers.
+ */
+class KdTree {
+public:
+    static constexpr u32 LEAF_SIZE = 8;
+    static constexpr u32 MAX_DEPTH = 48;
+
+    /**
+     * A point found by search(), ordered by (d2, key).
+     */
+    struct Candidate {
+        f64 d2;
+        u32 key;
+        u32 index;
+
+        inline bool operator<(const Candidate& other) const {
+            return d2 < other.d2 || (d2 == other.d2 && key < other.key);
+        }
+    };
+
+    KdTree() = default;
+
+    /**
+     * Pre: keys is empty (keys are then the input indices) or matches points.
+     */
+    KdTree(std::span<const Vec2> points, std::span<const u32> keys = {});
+
+    inline size_t size() const { return index_.size(); }
+
+    /**
+     * Calls visit(k) for the input index k of every point within radius of p.
+     */
+    template <typename Visitor>
+    inline void forEachWithin(const Vec2& p, f64 radius, Visitor&& visit) const {
+        if (nodes_.empty()) {
+            return;
+        }
+        f64 radius2 = radius * radius;
+        std::array<u32, 2 * MAX_DEPTH + 2> stack;
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const auto& node = nodes_[stack[--top]];
+            if (boxDist2(node, p) > radius2) {
+                continue;
+            }
+            if (node.right == 0) {
+                for (u32 j = node.begin; j < node.end; ++j) {
+                    f64 dx = xs_[j] - p.x, dy = ys_[j] - p.y;
+                    if (dx * dx + dy * dy <= radius2) {
+                        visit(index_[j]);
+                    }
+                }
+                continue;
+            }
+            stack[top++] = node.right;
+            stack[top++] = static_cast<u32>(&node - nodes_.data()) + 1;
+        }
+    }
+
+    /**
+     * Merges into heap the k smallest candidates among the points with
+     * accept(k) true and d2 <= max_d2, where k is the input index.
+     * heap is a max-heap (std::push_heap) of at most k candidates and may
+     * already hold some, e.g. from other sources; its top bounds the search.
+     */
+    template <typename Accept>
+    inline void search(
+        const Vec2& p, size_t k, f64 max_d2, Accept&& accept, std::vector<Candidate>& heap
+    ) const {
+        if (nodes_.empty() || k == 0) {
+            return;
+        }
+        auto bound = [&] { return heap.size() < k ? max_d2 : heap.front().d2; };
+
+        std::array<std::pair<u32, f64>, 2 * MAX_DEPTH + 2> stack;
+        size_t top = 0;
+        stack[top++] = {0, boxDist2(nodes_[0], p)};
+        while (top > 0) {
+            auto [n, box_d2] = stack[--top];
+            if (box_d2 > bound()) {
+                continue;
+            }
+            const auto& node = nodes_[n];
+            if (node.right == 0) {
+                for (u32 j = node.begin; j < node.end; ++j) {
+                    f64 dx = xs_[j] - p.x, dy = ys_[j] - p.y;
+                    f64 d2 = dx * dx + dy * dy;
+                    if (d2 <= bound() && accept(index_[j])) {
+                        offer(heap, k, max_d2, {d2, key_[j], index_[j]});
+                    }
+                }
+                continue;
+            }
+            // The nearer child goes on top, so it is searched first.
+            f64 left_d2 = boxDist2(nodes_[n + 1], p);
+            f64 right_d2 = boxDist2(nodes_[node.right], p);
+            if (left_d2 <= right_d2) {
+                stack[top++] = {node.right, right_d2};
+                stack[top++] = {n + 1, left_d2};
+            } else {
+                stack[top++] = {n + 1, left_d2};
+                stack[top++] = {node.right, right_d2};
+            }
+        }
+    }
+
+    /**
+     * Adds c to the max-heap of the k best candidates within max_d2, if it
+     * qualifies.
+     */
+    static inline void offer(std::vector<Candidate>& heap, size_t k, f64 max_d2, const Candidate& c) {
+        if (c.d2 > max_d2 || k == 0) {
+            return;
+        }
+        if (heap.size() < k) {
+            heap.push_back(c);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (c < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = c;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+
+private:
+    struct Node {
+        f64 x_lo, y_lo, x_hi, y_hi;
+        u32 begin, end;
+        u32 right;              // 0 for leaves; the left child is the next node
+    };
+
+    u32 buildNode(u32 begin, u32 end, u32 depth, std::span<const Vec2> points);
+
+    static inline f64 boxDist2(const Node& node, const Vec2& p) {
+        f64 dx = std::max({node.x_lo - p.x, 0.0, p.x - node.x_hi});
+        f64 dy = std::max({node.y_lo - p.y, 0.0, p.y - node.y_hi});
+        return dx * dx + dy * dy;
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<u32> index_, key_;
+    std::vector<f64> xs_, ys_;
+};
+
+namespace ref {
+
+/**
+ * WorldIndex that buckets artifacts and wormhole entries in uniform grids,
+ * so that small-radius queries cost O(1) expected time. Celestial bodies
+ * move and are scanned as in NaiveWorldIndex.
+ * cell_size <= 0 derives the cell size per grid from its entity density.
+ */
+class GridWorldIndex : public NaiveWorldIndex {
+public:
+    explicit GridWorldIndex(const WorldData& world_data, f64 cell_size = 0.0f);
+
+    const shared_vec<WormHole> queryWormHoles(
+        const Vec2& position, f64 radius, f64 t_u
+    ) const override;
+    const shared_vec<Artifact> queryArtifacts(
+        const Vec2& position, f64 radius, f64 t_u
+    ) const override;
+
+    void visitWormHoles(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const WormHole&)> visit
+    ) const override;
+    void visitArtifacts(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const Artifact&)> visit
+    ) const override;
+
+private:
+    PointGrid wormhole_grid_;
+    PointGrid artifact_grid_;
+};
+
+/**
+ * GridWorldIndex whose celestial queries avoid evaluating every moving body.
+ * Stationary bodies sit in a fixed grid. [0, horizon) is cut into time
+ * buckets of bucket_dt, each with a grid over the elliptical bodies'
+ * positions at its middle. Within a bucket such a body stays inside its swept
+ * circle, of radius min(omega * max(a, b) * bucket_dt / 2, 2 * max(a, b)),
+ * around that position. Bodies are split into tiers of swept radii within a
+ * factor of 2, each with its own grids, so a query at t_u only evaluates
+ * pos(t_u) of the bodies whose centre lies within radius plus their tier's
+ * swept radius. Outside [0, horizon) it scans them. Other moving bodies have
+ * no speed bound and are always scanned.
+ */
+class SweptWorldIndex : public GridWorldIndex {
+public:
+    static constexpr u32 MAX_BUCKETS = 4096;
+    static constexpr size_t MAX_ENTRIES = size_t(1) << 21;     // bucket count * elliptical bodies
+    // Swept radii below the largest / 2^(MAX_TIERS - 1) share the last tier.
+    static constexpr u32 MAX_TIERS = 8;
+    // Swept radii are widened by this times the orbit's extent from the
+    // origin, for the rounding of pos().
+    static constexpr f64 ROUNDING_SLACK = 1e-9;
+
+    /**
+     * bucket_dt <= 0 spreads as many buckets over the horizon as MAX_BUCKETS
+     * and MAX_ENTRIES allow; a smaller bucket_dt is raised to that limit.
+     */
+    SweptWorldIndex(
+        const WorldData& world_data, f64 horizon,
+        f64 bucket_dt = 0.0f, f64 cell_size = 0.0f
+    );
+
+    const shared_vec<CelestialBody> queryCelestials(
+        const Vec2& position, f64 radius, f64 t_u
+    ) const override;
+
+    void visitCelestials(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+    ) const override;
+
+    inline size_t bucketCount() const { return bucket_count_; }
+    inline size_t tierCount() const { return tiers_.size(); }
+
+private:
+    /**
+     * Calls visit(slot, pos) for every body within radius of position at t_u,
+     * where slot is its position in WorldData::bodies() and pos = pos(t_u).
+     */
+    template <typename Visitor>
+    void forEachCelestial(const Vec2& position, f64 radius, f64 t_u, Visitor&& visit) const;
+
+    f64 bucket_dt_ = 1.0f;
+    size_t bucket_count_ = 0;
+    PointGrid static_grid_;
+
+    // Rep-inv: moving holds indices into WorldData::ellipticalBodies(), each
+    //   with a swept radius <= swept_radius; buckets[b] holds them at
+    //   ((b + 1/2) * bucket_dt_), in moving's order, for b < bucket_count_.
+    struct Tier {
+        f64 swept_radius = 0.0f;
+        std::vector<u32> moving;
+        std::vector<PointGrid> buckets;
+    };
+    std::vector<Tier> tiers_;
+};
+
+/**
+ * WorldIndex backed by KD-trees over artifacts, wormhole entries and
+ * stationary bodies, answering radius and nearest-neighbour queries in
+ * O(log n) expected time. Moving bodies are scanned.
+ */
+class KdTreeWorldIndex : public ::WorldIndex {
+public:
+    explicit KdTreeWorldIndex(const WorldData& world_data);
+
+    const shared_vec<CelestialBody> queryCelestials(
+        const Vec2& position, f64 radius, f64 t_u
+    ) const override;
+    const shared_vec<WormHole> queryWormHoles(
+        const Vec2& position, f64 radius, f64 t_u
+    ) const override;
+    const shared_vec<Artifact> queryArtifacts(
+        const Vec2& position, f64 radius, f64 t_u
+    ) const override;
+
+    std::vector<Neighbor> kNearest(
+        const Vec2& position, size_t k, f64 t_u, const QueryFilter& filter
+    ) const override;
+
+    void visitCelestials(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+    ) const override;
+    void visitWormHoles(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const WormHole&)> visit
+    ) const override;
+    void visitArtifacts(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const Artifact&)> visit
+    ) const override;
+
+private:
+    // As SweptWorldIndex::forEachCelestial.
+    template <typename Visitor>
+    void forEachCelestial(const Vec2& position, f64 radius, f64 t_u, Visitor&& visit) const;
+
+    KdTree static_bodies_;
+    KdTree wormholes_;
+    KdTree artifacts_;
+};
+
+}
@@ -3,13 +3,9 @@
 Entity::Entity(u32 id) : id(id) {}
 
 WormHole::WormHole(
-    u32 id, const Matrix &entry, const Matrix &exit, f64 t_open, f64 t_close
+    u32 id, const Vec2 &entry, const Vec2 &exit, f64 t_open, f64 t_close
 )   : Entity(id), entry(entry), exit(exit), t_open(t_open), t_close(t_close) {
     req(t_open < t_close, "WormHole t_open must be less than t_close.");
-    auto [m1, n1] = entry.shape();
-    auto [m2, n2] = exit.shape();
-    req(m1 == 2 && n1 == 1, "WormHole entry must be a 2x1 matrix.");
-    req(m2 == 2 && n2 == 1, "WormHole exit must be a 2x1 matrix.");
 }
 
 CelestialBody::CelestialBody(u32 id, f64 radius, f64 mass)
@@ -19,7 +15,7 @@ CelestialBody::CelestialBody(u32 id, f64 radius, f64 mass)
 }
 
 StationaryBody::StationaryBody(
-    u32 id, f64 radius, f64 mass, const Matrix &position
+    u32 id, f64 radius, f64 mass, const Vec2 &position
 )   : CelestialBody(id, radius, mass), position(position) {}
 
 OrbitingBody::OrbitingBody(
@@ -32,24 +28,47 @@ EllipticalOrbit::EllipticalOrbit(
     f64 a, f64 b,
     f64 omega,
     f64 phi,
-    const Matrix &center,
+    const Vec2 &center,
     f64 angle
 )   : center(center), a(a), b(b), omega(omega), phi(phi), angle(angle) {
     req(a > 0.0f, "EllipticalOrbit semi-major axis a must be positive.");
     req(b > 0.0f, "EllipticalOrbit semi-minor axis b must be positive.");
     req(omega > 0.0f, "EllipticalOrbit angular velocity omega must be positive.");
-    auto [m, n] = center.shape();
-    req(m == 2 && n == 1, "EllipticalOrbit center must be a 2x1 matrix.");
     req(angle >= 0.0f && angle < 2* MathConfig::pi, "EllipticalOrbit angle must be in [0, 2π).");
+    MathConfig::sincos(angle, sin_angle_, cos_angle_);
 }
 
-Artifact::Artifact(u32 id, const Matrix &position) 
-    : Entity(id), position(position) {
+TabulatedTrajectory::TabulatedTrajectory(
+    std::unique_ptr<const TrajectoryStrategy> source,
+    f64 t0, f64 t1, u32 samples
+)   : source_(std::move(source)) {
+    req(source_ != nullptr, "TabulatedTrajectory requires a valid source trajectory.");
+    req(samples >= 1, "TabulatedTrajectory needs at least one sample interval.");
 
-    auto [m, n] = position.shape();
-    req(m == 2 && n == 1, "Artifact position must be a 2x1 matrix.");
+    period_ = source_->period();
+    if (period_ > 0.0f) {
+        t0_ = 0.0f;
+        span_ = period_;
+    } else {
+        req(t0 < t1, "TabulatedTrajectory range must satisfy t0 < t1.");
+        t0_ = t0;
+        span_ = t1 - t0;
+    }
+    h_ = span_ / samples;
+    inv_h_ = 1.0f / h_;
+
+    pos_.reserve(samples + 1);
+    vel_.reserve(samples + 1);
+    for (u32 k = 0; k <= samples; ++k) {
+        auto [p, v] = source_->posVel(t0_ + k * h_);
+        pos_.push_back(p);
+        vel_.push_back(v);
+    }
 }
 
+Artifact::Artifact(u32 id, const Vec2 &position) 
+    : Entity(id), position(position) {}
+
 Spacecraft::Spacecraft(
     u32 id, f64 mass, f64 fuel, f64 min_fuel_to_land,
         const std::vector<f64>& thrust_levels, f64 exhaust_velocity
@@ -6,6 +6,7 @@
 #include <string>
 #include <variant>
 #include "utils/matrix.h"
+#include "utils/linalg.h"
 #include "utils/math.h"
 #include "utils/helpers.h"
 #include "utils/types.h"
@@ -34,7 +35,11 @@ struct CelestialBody : Entity {
 
     CelestialBody(u32 id, f64 radius, f64 mass);
 
-    virtual Matrix pos(f64 t) const = 0;
+    virtual Vec2 pos(f64 t) const = 0;
+    virtual Vec2 vel(f64 t) const = 0;
+
+    inline virtual PosVel posVel(f64 t) const { return {pos(t), vel(t)}; }
+
     virtual ~CelestialBody() = default;
 };
 
@@ -46,32 +51,74 @@ struct OrbitingBody : CelestialBody {
         std::unique_ptr<const TrajectoryStrategy> strategy
     );
 
-    inline Matrix pos(f64 t) const override { return trajectory_strategy->pos(t); }
+    inline Vec2 pos(f64 t) const override { return trajectory_strategy->pos(t); }
+    inline Vec2 vel(f64 t) const override { return trajectory_strategy->vel(t); }
+    inline PosVel posVel(f64 t) const override { return trajectory_strategy->posVel(t); }
 };
 
 /**
  * Stationary body implementation.
- * Rep-inv: position is a 2x1 matrix representing fixed (x, y) coordinates.
+ * Rep-inv: position represents fixed (x, y) coordinates.
  */
 struct StationaryBody : CelestialBody {
-    const Matrix position;
+    const Vec2 position;
+
+    StationaryBody(u32 id, f64 radius, f64 mass, const Vec2& position);
+
+    inline Vec2 pos(f64) const override { return position; }
+    inline Vec2 vel(f64) const override { return Vec2::zero(); }
+};
+
+// ------------------- Partitioned body storage -------------------
+
+/**
+ * Plain records of bodies by concrete kind, which WorldData keeps in one
+ * contiguous array per kind so that loops over bodies make direct, inlinable
+ * pos() calls instead of two levels of virtual dispatch.
+ * index is the position of the body in WorldData::bodies().
+ */
 
-    StationaryBody(u32 id, f64 radius, f64 mass, const Matrix& position);
+struct StationaryBodyData {
+    u32 id, index;
+    f64 radius, mass;
+    Vec2 position;
+
+    inline Vec2 pos(f64) const { return position; }
+    inline Vec2 vel(f64) const { return Vec2::zero(); }
+};
+
+struct EllipticalBodyData {
+    u32 id, index;
+    f64 radius, mass;
+    EllipticalOrbit orbit; // final, so these calls are not virtual
+
+    inline Vec2 pos(f64 t) const { return orbit.pos(t); }
+    inline Vec2 vel(f64 t) const { return orbit.vel(t); }
+};
+
+/**
+ * Fallback for bodies of any other kind; forwards to the polymorphic body.
+ */
+struct OtherBodyData {
+    u32 id, index;
+    f64 radius, mass;
+    const CelestialBody* body;
 
-    inline Matrix pos(f64 t) const override { return position; }
+    inline Vec2 pos(f64 t) const { return body->pos(t); }
+    inline Vec2 vel(f64 t) const { return body->vel(t); }
 };
 
 /**
  * WormHole entity implementation.
- * Rep-inv: entry, exit in R^2 represented as 2x1 matrices; t_open < t_close.
+ * Rep-inv: entry, exit in R^2; t_open < t_close.
  */
 struct WormHole : Entity {
-    const Matrix entry;
-    const Matrix exit;
+    const Vec2 entry;
+    const Vec2 exit;
     f64 t_open;
     f64 t_close;
 
-    WormHole(u32 id, const Matrix& entry, const Matrix& exit, f64 t_open, f64 t_close);
+    WormHole(u32 id, const Vec2& entry, const Vec2& exit, f64 t_open, f64 t_close);
 
     inline bool isOpen(f64 t) const {
         return t >= t_open && t <= t_close;
@@ -80,14 +127,14 @@ struct WormHole : Entity {
 
 /**
  * Artifact entity implementation.
- * Rep-inv: position is a 2x1 matrix representing fixed (x, y) coordinates.
+ * Rep-inv: position represents fixed (x, y) coordinates.
  */
 struct Artifact : Entity {
-    const Matrix position;
+    const Vec2 position;
 
-    Artifact(u32 id, const Matrix& position);
+    Artifact(u32 id, const Vec2& position);
 
-    inline Matrix pos(f64 t) const { return position; }
+    inline Vec2 pos(f64 t) const { return position; }
 };
 
 struct Spacecraft : Entity {
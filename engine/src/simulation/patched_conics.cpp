@@ -0,0 +1,147 @@
+#include "patched_conics.h"
+
+#include <cmath>
+
+namespace ref {
+
+// ---------------- PatchedConicsEnvironment ----------------
+
+PatchedConicsEnvironment::PatchedConicsEnvironment(const WorldData& world_data)
+    : PatchedConicsEnvironment::EnvironmentModel(world_data) {
+    const auto& soa = world_data_.bodySoA();
+    for (size_t k = 0; k < soa.size(); ++k) {
+        gm_.push_back(MathConfig::G * soa.masses()[k]);
+        bodies_.push_back(world_data_.body(soa.ids()[k]));
+    }
+}
+
+PatchedConicsEnvironment::Dominant PatchedConicsEnvironment::dominant(
+    const Vec2& position, f64 t_u
+) const {
+    // Per-thread scratch, so concurrent queries do not share it.
+    thread_local std::vector<f64> xs, ys;
+    xs.resize(gm_.size());
+    ys.resize(gm_.size());
+    world_data_.bodySoA().positionsAt(t_u, xs, ys);
+
+    // Compares G m_i / d_i^2 against the best so far without dividing.
+    Dominant best{NONE, Vec2()};
+    f64 best_gm = 0.0f, best_d2 = 1.0f;
+    for (size_t k = 0; k < gm_.size(); ++k) {
+        Vec2 r(xs[k] - position.x, ys[k] - position.y);
+        auto d2 = MathConfig::norm2Sq(r);
+        if (gm_[k] * best_d2 > best_gm * d2 || best.k == NONE) {
+            best = {k, r};
+            best_gm = gm_[k];
+            best_d2 = d2;
+        }
+    }
+    return best;
+}
+
+size_t PatchedConicsEnvironment::dominantBody(const Vec2& position, f64 t_u) const {
+    return dominant(position, t_u).k;
+}
+
+Vec2 PatchedConicsEnvironment::gravity(const Vec2& position, f64 t_u) const {
+    auto [k, r] = dominant(position, t_u);
+    if (k == NONE) {
+        return Vec2();
+    }
+    auto d2 = MathConfig::norm2Sq(r);
+    return r * (gm_[k] * MathConfig::epsilonDiv(1.0f, d2 * std::sqrt(d2)));
+}
+
+f64 PatchedConicsEnvironment::potential(const Vec2& position, f64 t_u) const {
+    auto [k, r] = dominant(position, t_u);
+    if (k == NONE) {
+        return 0.0f;
+    }
+    return -MathConfig::epsilonDiv(gm_[k], std::sqrt(MathConfig::norm2Sq(r)));
+}
+
+f64 PatchedConicsEnvironment::gamma(const Vec2& position, const Vec2& velocity, f64 t_u) const {
+    return 1.0 / invGamma(position, velocity, t_u);
+}
+
+f64 PatchedConicsEnvironment::invGamma(const Vec2& position, const Vec2& velocity, f64 t_u) const {
+    return weakFieldInvGamma(potential(position, t_u), MathConfig::dot(velocity, velocity));
+}
+
+FieldSample PatchedConicsEnvironment::evaluate(
+    const Vec2& position, const Vec2& velocity, f64 t_u
+) const {
+    auto [k, r] = dominant(position, t_u);
+    Vec2 a;
+    f64 phi = 0.0f;
+    if (k != NONE) {
+        auto d2 = MathConfig::norm2Sq(r);
+        auto d = std::sqrt(d2);
+        a = r * (gm_[k] * MathConfig::epsilonDiv(1.0f, d2 * d));
+        phi = -MathConfig::epsilonDiv(gm_[k], d);
+    }
+    auto v2 = MathConfig::dot(velocity, velocity);
+    return {a, phi, 1.0 / weakFieldInvGamma(phi, v2)};
+}
+
+bool PatchedConicsEnvironment::keplerArc(
+    size_t k, Vec2& x, Vec2& v, f64 t_u, f64 h, f64& chi
+) const {
+    auto [p0, w0] = bodies_[k]->posVel(t_u);
+    Vec2 r = x - p0, u = v - w0;
+    if (!MathConfig::keplerStep(r, u, gm_[k], h, chi)) {
+        return false;
+    }
+    auto [p1, w1] = bodies_[k]->posVel(t_u + h);
+    x = p1 + r;
+    v = w1 + u;
+    return true;
+}
+
+bool PatchedConicsEnvironment::propagateCoast(Vec2& x, Vec2& v, f64 t_u, f64 dt_u) const {
+    size_t k = dominantBody(x, t_u);
+    if (k == NONE) {
+        return false;
+    }
+
+    Vec2 xc = x, vc = v;
+    f64 t = t_u, remaining = dt_u, h = dt_u;
+    f64 h_min = std::ldexp(dt_u, -static_cast<i32>(MAX_SOI_HALVINGS));
+    f64 chi = 0.0f, chi_h = 0.0f;       // last anomaly about k and its step
+
+    while (remaining > 0.0f) {
+        h = std::min(h, remaining);
+        Vec2 x1 = xc, v1 = vc;
+        f64 chi1 = (chi_h > 0.0f) ? chi * (h / chi_h) : 0.0f;
+        if (!keplerArc(k, x1, v1, t, h, chi1)) {
+            return false;
+        }
+
+        // An arc that ends in another body's region is retried shorter, until
+        // the crossing is pinned down; the next arc then follows that body.
+        size_t k1 = dominantBody(x1, t + h);
+        if (k1 != k && h > h_min) {
+            h *= 0.5;
+            continue;
+        }
+
+        xc = x1;
+        vc = v1;
+        t += h;
+        remaining = (h == remaining) ? 0.0f : remaining - h;
+        if (k1 != k) {
+            k = k1;
+            chi_h = 0.0f;
+        } else {
+            chi = chi1;
+            chi_h = h;
+        }
+        h = remaining;
+    }
+
+    x = xc;
+    v = vc;
+    return true;
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "utils/types.h"
+#include "utils/math.h"
+#include "utils/linalg.h"
+#include "simulation/world.h"
+
+namespace ref {
+
+/**
+ * Patched-conics approximation of ConcreteEnvironment: at every point only
+ * the dominant body, the one with the strongest pull G m / d^2, attracts.
+ * The region where a body dominates stands in for its sphere of influence.
+ * Coasts are propagated as Kepler arcs about the dominant body, in a frame
+ * that moves with it, and switch bodies where the arcs leave its region;
+ * the crossing is located to dt_u / 2^MAX_SOI_HALVINGS.
+ * Arcs ignore the acceleration of the body they follow, so long coasts
+ * around orbiting bodies should be split into substeps. Substeps also bound
+ * what propagateCoast() can miss: it checks the dominant body only at arc
+ * endpoints, so an arc that enters another body's region and leaves it again
+ * within one substep is never patched.
+ * Immutable after construction, so one instance may be queried concurrently.
+ */
+class PatchedConicsEnvironment : public ::EnvironmentModel {
+public:
+    static constexpr u32 MAX_SOI_HALVINGS = 12;
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    explicit PatchedConicsEnvironment(const WorldData& world_data);
+
+    Vec2 gravity(
+        const Vec2& position, f64 t_u
+    ) const override;
+    f64 potential(
+        const Vec2& position, f64 t_u
+    ) const override;
+    f64 gamma(
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const override;
+    f64 invGamma(
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const override;
+    FieldSample evaluate(
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const override;
+
+    bool propagateCoast(Vec2& x, Vec2& v, f64 t_u, f64 dt_u) const override;
+
+    /**
+     * Returns the BodySoA index of the body dominating position at t_u, or
+     * NONE if the world has no bodies.
+     */
+    size_t dominantBody(const Vec2& position, f64 t_u) const;
+
+private:
+    struct Dominant {
+        size_t k;   // BodySoA index, or NONE
+        Vec2 r;     // from position to the body
+    };
+
+    Dominant dominant(const Vec2& position, f64 t_u) const;
+
+    /**
+     * Advances (x, v) by h along the Kepler arc about body k, starting at t_u.
+     * chi is the warm start of MathConfig::keplerStep.
+     */
+    bool keplerArc(size_t k, Vec2& x, Vec2& v, f64 t_u, f64 h, f64& chi) const;
+
+    // G * mass and the body itself, in BodySoA order.
+    std::vector<f64> gm_;
+    std::vector<const CelestialBody*> bodies_;
+};
+
+}
@@ -7,6 +7,10 @@ void ReferenceSimulation::initialize(const SimulationConfig& config) {
     config_.time_config             = config.time_config;
     config_.quantization_config     = config.quantization_config;
     config_.spacecraft_config       = config.spacecraft_config;
+    config_.integration_config      = config.integration_config;
+    config_.ephemeris_config        = config.ephemeris_config;
+    config_.environment_config      = config.environment_config;
+    config_.index_config            = config.index_config;
     config_.initial_state           = config.initial_state;
     config_.k                       = config.k;
 
@@ -52,20 +56,53 @@ void ReferenceSimulation::buildSpacecraft() {
 }
 
 void ReferenceSimulation::buildEnvironmentModel() {
-    env_model_ = std::make_unique<EnvironmentModel>(
-        *world_data_
-    );
+    const auto& ec = config_.environment_config;
+    switch (ec.kind) {
+        case EnvironmentKind::BarnesHut:
+            env_model_ = std::make_unique<BarnesHutEnvironment>(
+                *world_data_, ec.theta, ec.barnes_hut_time_slice
+            );
+            break;
+        case EnvironmentKind::PatchedConics:
+            env_model_ = std::make_unique<PatchedConicsEnvironment>(*world_data_);
+            break;
+        case EnvironmentKind::Direct:
+            env_model_ = std::make_unique<ConcreteEnvironment>(
+                *world_data_, ec.position_cache_quantum,
+                ec.static_grid_cells, ec.static_grid_near_radii
+            );
+            break;
+    }
 }
 
 void ReferenceSimulation::buildWorldIndex() {
-    world_index_ = std::make_unique<WorldIndex>(
-        *world_data_
-    );
+    const auto& ic = config_.index_config;
+    switch (ic.kind) {
+        case IndexKind::Grid:
+            world_index_ = std::make_unique<GridWorldIndex>(
+                *world_data_, ic.grid_cell_size
+            );
+            break;
+        case IndexKind::Swept:
+            world_index_ = std::make_unique<SweptWorldIndex>(
+                *world_data_, config_.time_config.tmax_u,
+                ic.swept_bucket_dt, ic.grid_cell_size
+            );
+            break;
+        case IndexKind::KdTree:
+            world_index_ = std::make_unique<KdTreeWorldIndex>(*world_data_);
+            break;
+        case IndexKind::Naive:
+            world_index_ = std::make_unique<NaiveWorldIndex>(
+                *world_data_
+            );
+            break;
+    }
 }
 
 void ReferenceSimulation::buildTimePolicy() {
     const auto& time_config = config_.time_config;
-    time_policy_ = std::make_unique<TimePolicy>(
+    time_policy_ = std::make_unique<SimpleTimePolicy>(
         *env_model_,
         time_config.tmax_u,
         time_config.dt_u
@@ -78,11 +115,19 @@ void ReferenceSimulation::buildSolver() {
 
     solver_ = std::make_unique<Solver>(
         quantizer,
-        std::make_shared<BFSSolver<StateVertex>>(),
+        std::make_shared<BFSSolver<std::shared_ptr<StateVertex>>>(),
         action_models
     );
 }
 
+PropagationConfig ReferenceSimulation::makePropagationConfig() const {
+    const auto& ic = config_.integration_config;
+    return PropagationConfig(
+        ic.integrator, ic.rtol, ic.atol, ic.max_steps,
+        ic.coast_integrator, ic.coast_substeps, ic.batch_actions
+    );
+}
+
 Quantizer ReferenceSimulation::makeQuantizer() const {
     const auto& qc = config_.quantization_config;
     QuantizerConfig config(qc.pos_bin, qc.vel_bin, qc.time_bin, qc.fuel_bin);
@@ -97,7 +142,8 @@ shared_vec<ActionModel> ReferenceSimulation::makeActionModels() const {
         *world_index_,
         *world_data_,
         *spacecraft_,
-        config_.spacecraft_config.possible_directions
+        config_.spacecraft_config.possible_directions,
+        makePropagationConfig()
     ));
     return models;
 }
@@ -105,8 +151,8 @@ shared_vec<ActionModel> ReferenceSimulation::makeActionModels() const {
 void ReferenceSimulation::compute() {
     auto iState = config_.initial_state;
     StateVertex start(
-        Matrix(2, 1, iState.position),
-        Matrix(2, 1, iState.velocity),
+        Vec2(iState.position),
+        Vec2(iState.velocity),
         0.0f,
         iState.fuel
     );
@@ -155,7 +201,9 @@ WorldFrame ReferenceSimulation::toFrame(const StateVertex& state) const {
     for (const auto& body : world_data_->bodies()) {
         BodyFrame body_frame;
         body_frame.id = body->id;
-        body_frame.x = body->pos(state.t_u);
+        auto [x, v] = body->posVel(state.t_u);
+        body_frame.x = x;
+        body_frame.v = v;
         body_frame.radius = body->radius;
         body_frame.mass = body->mass;
         frame.bodies.push_back(body_frame);
@@ -186,16 +234,22 @@ std::shared_ptr<CelestialBody> ReferenceSimulation::makeBody(
 ) const {
     auto result = std::visit(overloaded{
         [&](const StationaryBodyConfig& sbc) -> std::shared_ptr<CelestialBody> {
-            Matrix position(2, 1, sbc.position);
+            Vec2 position(sbc.position);
             return std::make_shared<StationaryBody>(
                 sbc.id, sbc.radius, sbc.mass, position
             );
         },
         [&](const TrajectoryConfig& tc) -> std::shared_ptr<CelestialBody> {
-            auto strategy = std::make_unique<EllipticalOrbit>(
+            std::unique_ptr<const TrajectoryStrategy> strategy = std::make_unique<EllipticalOrbit>(
                 tc.a, tc.b, tc.omega, tc.phi,
-                Matrix(2, 1, tc.center), tc.angle
+                Vec2(tc.center), tc.angle
             );
+            const auto& ec = config_.ephemeris_config;
+            if (ec.tabulate) {
+                strategy = std::make_unique<TabulatedTrajectory>(
+                    std::move(strategy), 0.0f, config_.time_config.tmax_u, ec.samples
+                );
+            }
             return std::make_shared<OrbitingBody>(
                 tc.id, tc.radius, tc.mass, std::move(strategy)
             );
@@ -208,8 +262,8 @@ std::shared_ptr<CelestialBody> ReferenceSimulation::makeBody(
 std::shared_ptr<WormHole> ReferenceSimulation::makeWormHole(
     const WormHoleConfig& wh_config
 ) const {
-    Matrix entry(2, 1, wh_config.entry);
-    Matrix exit(2, 1, wh_config.exit);
+    Vec2 entry(wh_config.entry);
+    Vec2 exit(wh_config.exit);
     return std::make_shared<WormHole>(
         wh_config.id, entry, exit, wh_config.t_open, wh_config.t_close
     );
@@ -218,7 +272,7 @@ std::shared_ptr<WormHole> ReferenceSimulation::makeWormHole(
 std::shared_ptr<Artifact> ReferenceSimulation::makeArtifact(
     const ArtifactConfig& art_config
 ) const {
-    Matrix position(2, 1, art_config.position);
+    Vec2 position(art_config.position);
     return std::make_shared<Artifact>(
         art_config.id, position
     );
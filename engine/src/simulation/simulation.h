@@ -5,6 +5,9 @@
 #include <stdexcept>
 #include "simulation/models.h"
 #include "simulation/world.h"
+#include "simulation/barnes_hut.h"
+#include "simulation/patched_conics.h"
+#include "simulation/index.h"
 #include "simulation/actions.h"
 #include "simulation/solver.h"
 #include "simulation/strategies.h"
@@ -77,6 +80,7 @@ namespace ref {
             const ArtifactConfig& art_config
         ) const;
         Quantizer makeQuantizer() const;
+        PropagationConfig makePropagationConfig() const;
         shared_vec<ActionModel> makeActionModels() const;
     };
 }    
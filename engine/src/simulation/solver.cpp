@@ -4,12 +4,13 @@ std::vector<StateAction> Solver::neighbors(const StateVertex& sv) const {
     std::vector<StateAction> result;
 
     for (const auto& action_model : action_models) {
+        action_model->beginExpansion(sv);
         auto actions = action_model->enumerate(sv);
-        for (const auto& action : actions) {
-            auto maybe_next = action_model->apply(sv, action);
-            if (maybe_next.has_value()) {
-                auto vertex = std::make_shared<StateVertex>(maybe_next.value());
-                result.push_back(StateAction(vertex, action));
+        auto applied = action_model->applyAll(sv, actions);
+        for (size_t k = 0; k < actions.size(); ++k) {
+            if (applied[k].has_value()) {
+                auto vertex = std::make_shared<StateVertex>(applied[k].value());
+                result.push_back(StateAction(vertex, actions[k]));
             }
         }
     }
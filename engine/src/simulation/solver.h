@@ -14,6 +14,7 @@
 #include "simulation/strategies.h"
 #include "utils/types.h"
 #include "utils/matrix.h"
+#include "utils/linalg.h"
 #include "utils/math.h"
 #include "utils/helpers.h"
 
@@ -22,14 +23,14 @@
 // ------------------------------------------------------------------
 
 struct DiscreteState {
-    const Matrix qx;
-    const Matrix qv;
+    const Vec2 qx;
+    const Vec2 qv;
     const f64 qt_u;
     const f64 qfuel;
     const uset<u32> collected_artifacts;
 
     inline DiscreteState(
-        const Matrix& qx, const Matrix& qv,
+        const Vec2& qx, const Vec2& qv,
         f64 qt_u, f64 qfuel,
         const uset<u32>& collected_artifacts = {}
     ) : qx(qx), qv(qv), qt_u(qt_u), qfuel(qfuel), 
@@ -48,12 +49,12 @@ template <>
 struct std::hash<DiscreteState> {
     inline size_t operator()(const DiscreteState& ds) const {
         size_t h = 0;
-        auto mat_hasher = std::hash<Matrix>();
+        auto vec_hasher = std::hash<Vec2>();
         auto flt_hasher = std::hash<f64>();
         auto uint_hasher = std::hash<u32>();
 
-        h = hash_combine(h, mat_hasher(ds.qx));
-        h = hash_combine(h, mat_hasher(ds.qv));
+        h = hash_combine(h, vec_hasher(ds.qx));
+        h = hash_combine(h, vec_hasher(ds.qv));
         h = hash_combine(h, flt_hasher(ds.qt_u));
         h = hash_combine(h, flt_hasher(ds.qfuel));
 
@@ -2,9 +2,20 @@
 
 #include <queue>
 #include <cmath>
+#include <memory>
+#include <vector>
 #include "utils/matrix.h"
+#include "utils/linalg.h"
+#include "utils/math.h"
 #include "utils/types.h"
 
+/**
+ * Position and velocity of an object at one instant.
+ */
+struct PosVel {
+    Vec2 pos, vel;
+};
+
 /**
  * Abstract base class for trajectory strategies.
  * Defines the interface for computing the position of an object in trajectory at time t.
@@ -12,20 +23,35 @@
 struct TrajectoryStrategy {
     /**
      * Returns the position of the object in trajectory at time t.
-     * Postcondition: returns a 2x1 matrix representing the (x, y) coordinates.
+     * Postcondition: returns a 2D vector representing the (x, y) coordinates.
      */
-    virtual Matrix pos(f64 t) const = 0;
+    virtual Vec2 pos(f64 t) const = 0;
 
     /**
      * Returns the velocity of the object in trajectory at time t.
-     * Postcondition: returns a 2x1 matrix representing the (vx, vy) components.
+     * The default is a forward difference over delta; strategies with a
+     * closed form override it.
+     * Postcondition: returns a 2D vector representing the (vx, vy) components.
      */
-    inline virtual Matrix vel(f64 t, f64 delta = 0.001f) const {
-        Matrix pos1 = pos(t);
-        Matrix pos2 = pos(t + delta);
+    inline virtual Vec2 vel(f64 t, f64 delta = 0.001f) const {
+        Vec2 pos1 = pos(t);
+        Vec2 pos2 = pos(t + delta);
         return (pos2 - pos1) * (1.0f / delta);
     }
 
+    /**
+     * Returns pos(t) and vel(t) together; overrides share the work between them.
+     */
+    inline virtual PosVel posVel(f64 t) const {
+        return {pos(t), vel(t)};
+    }
+
+    /**
+     * Returns the period of the trajectory, or 0 if it is not periodic.
+     * Post: pos(t + period()) == pos(t) for all t when period() > 0.
+     */
+    inline virtual f64 period() const { return 0.0f; }
+
     virtual ~TrajectoryStrategy() = default;
 };
 
@@ -38,38 +64,160 @@ struct TrajectoryStrategy {
  * AF(a, b, omega, phi, center, angle): 
  *   x = a * cos(omega * t + phi)
  *   y = b * sin(omega * t + phi)
- *   Matrix::rotate2d(angle) * [x; y; 1] + center
+ *   Mat3::rotate2d(angle) * [x; y] + center
  */
-struct EllipticalOrbit : public TrajectoryStrategy {
+struct EllipticalOrbit final : public TrajectoryStrategy {
     const f64 a, b, omega, phi;
-    const Matrix center;
+    const Vec2 center;
     const f64 angle;
 
     /**
      * Rep-inv: 
-     *   a, b, omega > 0; center is a 2x1 matrix; angle in radians;
+     *   a, b, omega > 0; angle in radians;
      *   angle is in [0, 2π)
+     *   cos_angle_ == cos(angle), sin_angle_ == sin(angle)
      */
 
-    EllipticalOrbit(f64 a, f64 b, f64 omega, f64 phi, const Matrix& center, f64 angle);
+    EllipticalOrbit(f64 a, f64 b, f64 omega, f64 phi, const Vec2& center, f64 angle);
+
+    inline f64 period() const override { return 2.0f * MathConfig::pi / omega; }
 
     /**
      * Returns the position of the object in elliptical trajectory at time t.
      * Pre: None
-     * Post: returns a 2x1 matrix representing the (x, y) coordinates.
+     * Post: returns a 2D vector representing the (x, y) coordinates.
+     */
+    inline Vec2 pos(f64 t) const override {
+        f64 s, c;
+        MathConfig::sincos(omega * t + phi, s, c);
+        return rotate(a * c, b * s) + center;
+    }
+
+    /**
+     * Returns the exact velocity, d/dt pos(t). delta is unused.
      */
-    inline Matrix pos(f64 t) const override {
-        f64 x = a * std::cos(omega * t + phi);
-        f64 y = b * std::sin(omega * t + phi);
+    inline Vec2 vel(f64 t, f64 /*delta*/ = 0.001f) const override {
+        f64 s, c;
+        MathConfig::sincos(omega * t + phi, s, c);
+        return rotate(-a * omega * s, b * omega * c);
+    }
 
-        Matrix point(3, 1, 1.0f);
-        point(0, 0) = x;
-        point(1, 0) = y;
+    inline PosVel posVel(f64 t) const override {
+        f64 s, c;
+        MathConfig::sincos(omega * t + phi, s, c);
+        return {rotate(a * c, b * s) + center, rotate(-a * omega * s, b * omega * c)};
+    }
+
+    inline f64 cosAngle() const { return cos_angle_; }
+    inline f64 sinAngle() const { return sin_angle_; }
 
-        Matrix rotated = Matrix::rotate2d(angle) * point;
-        Matrix translated = center + Matrix::fromHomogeneous(rotated);
-        return translated;
+private:
+    inline Vec2 rotate(f64 x, f64 y) const {
+        return {cos_angle_ * x - sin_angle_ * y, sin_angle_ * x + cos_angle_ * y};
     }
+
+    f64 cos_angle_, sin_angle_;
+};
+
+/**
+ * Ephemeris table over another trajectory.
+ * Samples pos and vel of the source once at construction, over one period if
+ * the source is periodic and over [t0, t1] otherwise, and serves pos(t) and
+ * vel(t) by cubic Hermite interpolation between the samples. Times outside
+ * [t0, t1] of an aperiodic source are forwarded to the source.
+ * Immutable after construction, so one instance may be read by many threads.
+ *
+ * Error bound, with h the sample spacing and M4 = max |d^4 pos / dt^4|:
+ *   |pos(t) - source.pos(t)| <= h^4 / 384 * M4
+ *   |vel(t) - source.vel(t)| <= sqrt(3) / 216 * h^3 * M4
+ * given exact source velocities (see TrajectoryStrategy::vel).
+ * For an EllipticalOrbit, M4 <= omega^4 * max(a, b).
+ *
+ * AF(source, t0, h, nodes): the piecewise cubic p with p(t0 + k*h) = pos_k and
+ *   p'(t0 + k*h) = vel_k for 0 <= k <= samples.
+ */
+struct TabulatedTrajectory : public TrajectoryStrategy {
+    /**
+     * Rep-inv:
+     *   samples >= 1; h_ > 0; pos_.size() == vel_.size() == samples + 1;
+     *   period_ > 0 iff the source is periodic, in which case t0_ == 0.
+     */
+
+    /**
+     * Pre: source != nullptr; samples >= 1; t0 < t1 unless source is periodic.
+     */
+    TabulatedTrajectory(
+        std::unique_ptr<const TrajectoryStrategy> source,
+        f64 t0, f64 t1, u32 samples
+    );
+
+    inline Vec2 pos(f64 t) const override {
+        size_t k;
+        f64 s;
+        if (!locate(t, k, s)) { return source_->pos(t); }
+
+        f64 s2 = s * s, s3 = s2 * s;
+        f64 h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+        f64 h10 = s3 - 2.0f * s2 + s;
+        f64 h01 = -2.0f * s3 + 3.0f * s2;
+        f64 h11 = s3 - s2;
+        return pos_[k] * h00 + vel_[k] * (h10 * h_) + pos_[k + 1] * h01 + vel_[k + 1] * (h11 * h_);
+    }
+
+    inline Vec2 vel(f64 t, f64 delta = 0.001f) const override {
+        size_t k;
+        f64 s;
+        if (!locate(t, k, s)) { return source_->vel(t, delta); }
+
+        f64 s2 = s * s;
+        f64 d00 = 6.0f * s2 - 6.0f * s;
+        f64 d10 = 3.0f * s2 - 4.0f * s + 1.0f;
+        f64 d11 = 3.0f * s2 - 2.0f * s;
+        return (pos_[k] - pos_[k + 1]) * (d00 * inv_h_) + vel_[k] * d10 + vel_[k + 1] * d11;
+    }
+
+    inline PosVel posVel(f64 t) const override {
+        return {pos(t), vel(t)};
+    }
+
+    inline f64 period() const override { return period_; }
+
+    inline f64 step() const { return h_; }
+
+    /**
+     * Returns the trajectory the table was sampled from.
+     */
+    inline const TrajectoryStrategy& source() const { return *source_; }
+
+    /**
+     * Returns the position error bound h^4 / 384 * max_d4.
+     * Pre: max_d4 bounds |d^4 pos / dt^4| of the source.
+     */
+    inline f64 errorBound(f64 max_d4) const {
+        return h_ * h_ * h_ * h_ / 384.0f * max_d4;
+    }
+
+private:
+    /**
+     * Finds the interval k and the local coordinate s in [0, 1] of time t.
+     * Returns false if t lies outside the table of an aperiodic source.
+     */
+    inline bool locate(f64 t, size_t& k, f64& s) const {
+        f64 tau = t - t0_;
+        if (period_ > 0.0f) {
+            tau -= std::floor(tau / period_) * period_;
+        } else if (tau < 0.0f || tau > span_) {
+            return false;
+        }
+        f64 u = tau * inv_h_;
+        k = std::min(static_cast<size_t>(u), pos_.size() - 2);
+        s = u - static_cast<f64>(k);
+        return true;
+    }
+
+    const std::unique_ptr<const TrajectoryStrategy> source_;
+    f64 t0_, span_, period_, h_, inv_h_;
+    std::vector<Vec2> pos_, vel_;
 };
 
 /**
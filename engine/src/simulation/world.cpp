@@ -1,5 +1,7 @@
 #include "world.h"
 
+#include "utils/simd.h"
+
 // ---------------- WorldData ----------------
 
 WorldData::WorldData(
@@ -10,63 +12,67 @@ WorldData::WorldData(
 ) : bodies_(std::move(bodies)),
     wormholes_(std::move(wormholes)),
     artifacts_(std::move(artifacts)),
-    max_radius_(max_radius) {}
-
-const shared_vec<CelestialBody>& WorldData::bodies(i32 id) const {
-    if (id == -1) {
-        return bodies_;
-    }
-    static shared_vec<CelestialBody> result;
-    result.clear();
-
-    auto it = std::find_if(
-        bodies_.begin(), bodies_.end(),
-        [id](const std::shared_ptr<CelestialBody>& body) {
-            return body->id == static_cast<u32>(id);
+    max_radius_(max_radius),
+    body_ids_(bodies_),
+    wormhole_ids_(wormholes_),
+    artifact_ids_(artifacts_) {
+    for (u32 k = 0; k < bodies_.size(); ++k) {
+        const auto* body = bodies_[k].get();
+        if (auto sb = dynamic_cast<const StationaryBody*>(body)) {
+            stationary_.push_back({sb->id, k, sb->radius, sb->mass, sb->position});
+            continue;
         }
-    );
-    if (it != bodies_.end()) {
-        result.push_back(*it);
+        auto ob = dynamic_cast<const OrbitingBody*>(body);
+        const TrajectoryStrategy* strategy = ob ? ob->trajectory_strategy.get() : nullptr;
+        if (auto table = dynamic_cast<const TabulatedTrajectory*>(strategy)) {
+            strategy = &table->source();
+        }
+        if (auto orbit = dynamic_cast<const EllipticalOrbit*>(strategy)) {
+            elliptical_.push_back({ob->id, k, ob->radius, ob->mass, *orbit});
+            continue;
+        }
+        other_.push_back({body->id, k, body->radius, body->mass, body});
     }
-    return result;
-}
+    body_soa_ = BodySoA(stationary_, elliptical_, other_);
 
-const shared_vec<WormHole>& WorldData::wormholes(i32 id) const {
-    if (id == -1) {
-        return wormholes_;
+    forEachBody([&](const auto& body) {
+        max_body_radius_ = std::max(max_body_radius_, body.radius);
+    });
+    for (const auto& body : stationary_) {
+        body_bounds_.expand(body.position, body.radius);
+    }
+    for (const auto& body : elliptical_) {
+        body_bounds_.expand(body.orbit.center, std::max(body.orbit.a, body.orbit.b) + body.radius);
+    }
+    if (!other_.empty()) {
+        // Arbitrary trajectories; centres beyond max_radius are out of play
+        // anyway, but their discs may still reach inside.
+        body_bounds_.expand(Vec2::zero(), max_radius_ + max_body_radius_);
     }
-    static shared_vec<WormHole> result;
-    result.clear();
 
-    auto it = std::find_if(
-        wormholes_.begin(), wormholes_.end(),
-        [id](const std::shared_ptr<WormHole>& wh) {
-            return wh->id == static_cast<u32>(id);
-        }
-    );
-    if (it != wormholes_.end()) {
-        result.push_back(*it);
+    bounds_ = body_bounds_;
+    for (const auto& wh : wormholes_) {
+        bounds_.expand(wh->entry);
+        bounds_.expand(wh->exit);
+    }
+    for (const auto& art : artifacts_) {
+        bounds_.expand(art->position);
     }
-    return result;
 }
 
-const shared_vec<Artifact>& WorldData::artifacts(i32 id) const {
-    if (id == -1) {
-        return artifacts_;
-    }
-    static shared_vec<Artifact> result;
-    result.clear();
+const CelestialBody* WorldData::body(u32 id) const {
+    u32 slot = body_ids_.find(id);
+    return slot != IdIndex::NONE ? bodies_[slot].get() : nullptr;
+}
 
-    auto it = std::find_if(
-        artifacts_.begin(), artifacts_.end(),
-        [id](const std::shared_ptr<Artifact>& art) {
-            return art->id == static_cast<u32>(id);
-        }
-    );
-    if (it != artifacts_.end()) {
-        result.push_back(*it);
-    }
-    return result;
+const WormHole* WorldData::wormhole(u32 id) const {
+    u32 slot = wormhole_ids_.find(id);
+    return slot != IdIndex::NONE ? wormholes_[slot].get() : nullptr;
+}
+
+const Artifact* WorldData::artifact(u32 id) const {
+    u32 slot = artifact_ids_.find(id);
+    return slot != IdIndex::NONE ? artifacts_[slot].get() : nullptr;
 }
 
 // ---------------- EnvironmentModel ----------------
@@ -74,11 +80,113 @@ const shared_vec<Artifact>& WorldData::artifacts(i32 id) const {
 EnvironmentModel::EnvironmentModel(const WorldData& world_data) 
     : world_data_(world_data) {}
 
+void EnvironmentModel::gravityBatch(
+    std::span<const f64> xs, std::span<const f64> ys, f64 t_u,
+    std::span<f64> ax, std::span<f64> ay, std::span<f64> phi
+) const {
+    req(ys.size() == xs.size() && ax.size() == xs.size() && ay.size() == xs.size(),
+        "gravityBatch spans must have the same size.");
+    req(phi.empty() || phi.size() == xs.size(), "gravityBatch phi must be empty or match the queries.");
+
+    for (size_t k = 0; k < xs.size(); ++k) {
+        Vec2 position(xs[k], ys[k]);
+        auto a = gravity(position, t_u);
+        ax[k] = a.x;
+        ay[k] = a.y;
+        if (!phi.empty()) {
+            phi[k] = potential(position, t_u);
+        }
+    }
+}
+
+void EnvironmentModel::evaluateBatch(
+    std::span<const f64> xs, std::span<const f64> ys,
+    std::span<const f64> vxs, std::span<const f64> vys,
+    std::span<const f64> ts, std::span<FieldSample> out
+) const {
+    req(ys.size() == xs.size() && vxs.size() == xs.size() && vys.size() == xs.size() &&
+        ts.size() == xs.size() && out.size() == xs.size(),
+        "evaluateBatch spans must have the same size.");
+
+    for (size_t k = 0; k < xs.size(); ++k) {
+        out[k] = evaluate(Vec2(xs[k], ys[k]), Vec2(vxs[k], vys[k]), ts[k]);
+    }
+}
+
 // ------------------- WorldIndex -------------------
 
 WorldIndex::WorldIndex(const WorldData& world_data)
     : world_data_(world_data) {}
 
+std::optional<Neighbor> WorldIndex::nearest(
+    const Vec2& position, f64 t_u, const QueryFilter& filter
+) const {
+    auto found = kNearest(position, 1, t_u, filter);
+    if (found.empty()) {
+        return std::nullopt;
+    }
+    return found.front();
+}
+
+std::vector<Neighbor> WorldIndex::kNearest(
+    const Vec2& position, size_t k, f64 t_u, const QueryFilter& filter
+) const {
+    std::vector<Neighbor> found;
+    auto consider = [&](u32 id, const Vec2& p) {
+        if (!filter.admits(id)) {
+            return;
+        }
+        auto d = MathConfig::dist(p, position);
+        if (d <= filter.max_distance) {
+            found.push_back({id, d});
+        }
+    };
+
+    switch (filter.kind) {
+        case EntityKind::Celestial:
+            world_data_.forEachBody([&](const auto& body) { consider(body.id, body.pos(t_u)); });
+            break;
+        case EntityKind::WormHole:
+            for (const auto& wh : world_data_.wormholes()) { consider(wh->id, wh->entry); }
+            break;
+        case EntityKind::Artifact:
+            for (const auto& art : world_data_.artifacts()) { consider(art->id, art->position); }
+            break;
+    }
+
+    auto m = std::min(k, found.size());
+    std::partial_sort(found.begin(), found.begin() + m, found.end());
+    found.resize(m);
+    return found;
+}
+
+void WorldIndex::visitCelestials(
+    const Vec2& position, f64 radius, f64 t_u,
+    FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+) const {
+    for (const auto& body : queryCelestials(position, radius, t_u)) {
+        visit(*body, body->pos(t_u));
+    }
+}
+
+void WorldIndex::visitWormHoles(
+    const Vec2& position, f64 radius, f64 t_u,
+    FunctionRef<void(const WormHole&)> visit
+) const {
+    for (const auto& wh : queryWormHoles(position, radius, t_u)) {
+        visit(*wh);
+    }
+}
+
+void WorldIndex::visitArtifacts(
+    const Vec2& position, f64 radius, f64 t_u,
+    FunctionRef<void(const Artifact&)> visit
+) const {
+    for (const auto& art : queryArtifacts(position, radius, t_u)) {
+        visit(*art);
+    }
+}
+
 // ------------------- TimePolicy -------------------
 
 TimePolicy::TimePolicy(
@@ -95,53 +203,237 @@ namespace ref {
 
 // ---------------- ConcreteEnvironment ----------------
 
+namespace {
+
+/**
+ * Evaluates all body positions at t_u into per-thread scratch, so that
+ * concurrent queries on one environment do not share buffers.
+ * Post: the returned arrays hold soa.size() coordinates in BodySoA order and
+ *   stay valid until the next call on this thread.
+ */
+std::pair<const f64*, const f64*> bodyPositions(const BodySoA& soa, f64 t_u) {
+    thread_local std::vector<f64> xs, ys;
+    xs.resize(soa.size());
+    ys.resize(soa.size());
+    soa.positionsAt(t_u, xs, ys);
+    return {xs.data(), ys.data()};
+}
+
+}
+
 ConcreteEnvironment::ConcreteEnvironment(
-    const WorldData& world_data
-)   : ConcreteEnvironment::EnvironmentModel(world_data) {}
+    const WorldData& world_data, f64 cache_quantum, u32 static_grid_cells, f64 near_radii
+)   : ConcreteEnvironment::EnvironmentModel(world_data), cache_quantum_(cache_quantum) {
+    req(cache_quantum >= 0.0f, "ConcreteEnvironment cache quantum must be non-negative.");
 
-Matrix ConcreteEnvironment::gravity(const Matrix& position, f64 t_u) const {
-    Matrix a(2, 1, 0.0f);
-    auto r = position;
+    for (auto mass : world_data_.bodySoA().masses()) {
+        gm_.push_back(MathConfig::G * mass);
+    }
+
+    if (static_grid_cells > 0 && !world_data_.stationaryBodies().empty()) {
+        static_grid_.emplace(
+            world_data_.stationaryBodies(), world_data_.max_radius(),
+            static_grid_cells, near_radii
+        );
+        first_body_ = world_data_.bodySoA().stationaryCount();
+    }
+}
+
+std::pair<const f64*, const f64*> ConcreteEnvironment::positions(f64 t_u) const {
+    const auto& soa = world_data_.bodySoA();
+    f64 ratio = cache_quantum_ > 0.0f ? t_u / cache_quantum_ : MathConfig::infinity;
+    if (!(std::fabs(ratio) < MAX_CACHE_KEY)) {
+        return bodyPositions(soa, t_u);
+    }
+
+    auto& cache = cache_.local();
+    size_t n = soa.size();
+    i64 key = std::llround(ratio);
+    if (auto it = cache.slots.find(key); it != cache.slots.end()) {
+        ++cache.stats.hits;
+        return {cache.xs.data() + it->second * n, cache.ys.data() + it->second * n};
+    }
+
+    ++cache.stats.misses;
+    if (cache.slots.size() >= MAX_CACHED_TIMES) {
+        resetCache();
+    }
+    size_t slot = cache.slots.size();
+    cache.slots.emplace(key, slot);
+    cache.xs.resize((slot + 1) * n);
+    cache.ys.resize((slot + 1) * n);
+
+    std::span<f64> xs(cache.xs.data() + slot * n, n);
+    std::span<f64> ys(cache.ys.data() + slot * n, n);
+    soa.positionsAt(static_cast<f64>(key) * cache_quantum_, xs, ys);
+    return {xs.data(), ys.data()};
+}
+
+bool ConcreteEnvironment::sameSnapshot(f64 a, f64 b) const {
+    const auto& soa = world_data_.bodySoA();
+    if (a == b || soa.stationaryCount() == soa.size()) {
+        return true;
+    }
+    if (cache_quantum_ <= 0.0f) {
+        return false;
+    }
+    f64 ra = a / cache_quantum_, rb = b / cache_quantum_;
+    return std::fabs(ra) < MAX_CACHE_KEY && std::fabs(rb) < MAX_CACHE_KEY &&
+        std::llround(ra) == std::llround(rb);
+}
+
+void ConcreteEnvironment::resetCache() const {
+    auto& cache = cache_.local();
+    cache.slots.clear();
+    cache.xs.clear();
+    cache.ys.clear();
+}
 
-    for (const auto& body : world_data_.bodies()) {
-        auto ri = body->pos(t_u);
-        auto Ri = ri - r;
-        auto d = MathConfig::normp(Ri, 2);
-        auto inv_d = MathConfig::epsilonDiv(1.0f, d*d*d);
-        a = a + Ri * (MathConfig::G * body->mass * inv_d);
+Vec2 ConcreteEnvironment::gravity(const Vec2& position, f64 t_u) const {
+    Vec2 a;
+    auto r = position;
+    const auto& soa = world_data_.bodySoA();
+    auto [xs, ys] = positions(t_u);
+    auto masses = soa.masses();
+
+    for (size_t i = first_body_; i < soa.size(); ++i) {
+        Vec2 Ri(xs[i] - r.x, ys[i] - r.y);
+        auto d2 = MathConfig::norm2Sq(Ri);
+        auto inv_d = MathConfig::epsilonDiv(1.0f, d2 * std::sqrt(d2));
+        a = a + Ri * (MathConfig::G * masses[i] * inv_d);
+    }
+    if (static_grid_) {
+        f64 phi = 0.0f;
+        static_grid_->accumulate(position, a, phi);
     }
 
     return a;
 }
 
-f64 ConcreteEnvironment::potential(const Matrix& position, f64 t_u) const {
+f64 ConcreteEnvironment::potential(const Vec2& position, f64 t_u) const {
     f64 phi = 0.0f;
     auto r = position;
 
-    for (const auto& body : world_data_.bodies()) {
-        auto ri = body->pos(t_u);
-        auto Ri = ri - r;
-        auto d = MathConfig::normp(Ri, 2);
-        phi += MathConfig::epsilonDiv(MathConfig::G * body->mass, d);
+    const auto& soa = world_data_.bodySoA();
+    auto [xs, ys] = positions(t_u);
+    auto masses = soa.masses();
+
+    for (size_t i = first_body_; i < soa.size(); ++i) {
+        auto d = MathConfig::dist(Vec2(xs[i], ys[i]), r);
+        phi += MathConfig::epsilonDiv(MathConfig::G * masses[i], d);
     }
+    phi = phi * -1.0f;
+    if (static_grid_) {
+        Vec2 a;
+        static_grid_->accumulate(position, a, phi);
+    }
+
+    return phi;
+}
 
-    return phi * -1.0f;
+f64 ConcreteEnvironment::gamma(const Vec2& position, const Vec2& velocity, f64 t_u) const {
+    return 1.0 / invGamma(position, velocity, t_u);
 }
 
-f64 ConcreteEnvironment::gamma(const Matrix& position, const Matrix& velocity, f64 t_u) const {
+f64 ConcreteEnvironment::invGamma(const Vec2& position, const Vec2& velocity, f64 t_u) const {
     auto v2 = MathConfig::dot(velocity, velocity);
     auto phi = potential(position, t_u);
-    auto c2 = MathConfig::c * MathConfig::c;
-
-    return 1.0 / (1.0 + phi / c2 - v2 / (2.0 * c2));
+    return weakFieldInvGamma(phi, v2);
 }
 
-f64 ConcreteEnvironment::invGamma(const Matrix& position, const Matrix& velocity, f64 t_u) const {
+FieldSample ConcreteEnvironment::evaluate(
+    const Vec2& position, const Vec2& velocity, f64 t_u
+) const {
+    Vec2 a;
+    f64 phi = 0.0f;
+    auto r = position;
+    const auto& soa = world_data_.bodySoA();
+    auto [xs, ys] = positions(t_u);
+    auto masses = soa.masses();
+
+    // One distance per body serves both the field and the potential.
+    for (size_t i = first_body_; i < soa.size(); ++i) {
+        Vec2 Ri(xs[i] - r.x, ys[i] - r.y);
+        auto d2 = MathConfig::norm2Sq(Ri);
+        auto d = std::sqrt(d2);
+        auto gm = MathConfig::G * masses[i];
+        a = a + Ri * (gm * MathConfig::epsilonDiv(1.0f, d2 * d));
+        phi += MathConfig::epsilonDiv(gm, d);
+    }
+    phi = phi * -1.0f;
+    if (static_grid_) {
+        static_grid_->accumulate(position, a, phi);
+    }
+
     auto v2 = MathConfig::dot(velocity, velocity);
-    auto phi = potential(position, t_u);
-    auto c2 = MathConfig::c * MathConfig::c;
+    return {a, phi, 1.0 / weakFieldInvGamma(phi, v2)};
+}
+
+void ConcreteEnvironment::gravityBatch(
+    std::span<const f64> xs, std::span<const f64> ys, f64 t_u,
+    std::span<f64> ax, std::span<f64> ay, std::span<f64> phi
+) const {
+    size_t nq = xs.size();
+    req(ys.size() == nq && ax.size() == nq && ay.size() == nq,
+        "gravityBatch spans must have the same size.");
+    req(phi.empty() || phi.size() == nq, "gravityBatch phi must be empty or match the queries.");
+
+    auto [bx, by] = positions(t_u);
+    size_t nb = gm_.size() - first_body_;
+    simd::kernels().gravity(
+        xs.data(), ys.data(), nq,
+        bx + first_body_, by + first_body_, gm_.data() + first_body_, nb,
+        MathConfig::epsilon, ax.data(), ay.data(), phi.empty() ? nullptr : phi.data()
+    );
+
+    for (auto& p : phi) {
+        p = p * -1.0f;
+    }
+    if (static_grid_) {
+        for (size_t k = 0; k < nq; ++k) {
+            Vec2 a(ax[k], ay[k]);
+            f64 p = phi.empty() ? 0.0f : phi[k];
+            static_grid_->accumulate(Vec2(xs[k], ys[k]), a, p);
+            ax[k] = a.x;
+            ay[k] = a.y;
+            if (!phi.empty()) {
+                phi[k] = p;
+            }
+        }
+    }
+}
+
+void ConcreteEnvironment::evaluateBatch(
+    std::span<const f64> xs, std::span<const f64> ys,
+    std::span<const f64> vxs, std::span<const f64> vys,
+    std::span<const f64> ts, std::span<FieldSample> out
+) const {
+    size_t n = xs.size();
+    req(vxs.size() == n && vys.size() == n && ts.size() == n && out.size() == n,
+        "evaluateBatch spans must have the same size.");
+
+    thread_local std::vector<f64> ax, ay, phi;
+    ax.resize(n);
+    ay.resize(n);
+    phi.resize(n);
+    for (size_t first = 0; first < n;) {
+        size_t last = first + 1;
+        while (last < n && sameSnapshot(ts[first], ts[last])) {
+            ++last;
+        }
+        size_t count = last - first;
+        gravityBatch(
+            xs.subspan(first, count), ys.subspan(first, count), ts[first],
+            std::span<f64>(ax).subspan(first, count), std::span<f64>(ay).subspan(first, count),
+            std::span<f64>(phi).subspan(first, count)
+        );
+        first = last;
+    }
 
-    return 1.0 + phi / c2 - v2 / (2.0 * c2);
+    for (size_t k = 0; k < n; ++k) {
+        auto v2 = vxs[k] * vxs[k] + vys[k] * vys[k];
+        out[k] = {Vec2(ax[k], ay[k]), phi[k], 1.0 / weakFieldInvGamma(phi[k], v2)};
+    }
 }
 
 // ---------------- NaiveWorldIndex ----------------
@@ -150,25 +442,27 @@ NaiveWorldIndex::NaiveWorldIndex(const WorldData& world_data)
     : NaiveWorldIndex::WorldIndex(world_data) {}
 
 const shared_vec<CelestialBody> NaiveWorldIndex::queryCelestials(
-    const Matrix& position, f64 radius, f64 t_u
+    const Vec2& position, f64 radius, f64 t_u
 ) const {
     shared_vec<CelestialBody> result;
-    for (const auto& body : world_data_.bodies()) {
-        auto body_pos = body->pos(t_u);
-        if (MathConfig::normp(body_pos - position, 2) <= radius) {
-            result.push_back(body);
+    f64 radius2 = radius * radius;
+    const auto& bodies = world_data_.bodies();
+    world_data_.forEachBody([&](const auto& body) {
+        if (MathConfig::distSq(body.pos(t_u), position) <= radius2) {
+            result.push_back(bodies[body.index]);
         }
-    }
+    });
     return result;
 }
 
 const shared_vec<WormHole> NaiveWorldIndex::queryWormHoles(
-    const Matrix& position, f64 radius, f64 t_u
+    const Vec2& position, f64 radius, f64 t_u
 ) const {
     shared_vec<WormHole> result;
+    f64 radius2 = radius * radius;
     for (const auto& wh : world_data_.wormholes()) {
         auto entry_pos = wh->entry;
-        if (MathConfig::normp(entry_pos - position, 2) <= radius) {
+        if (MathConfig::distSq(entry_pos, position) <= radius2) {
             result.push_back(wh);
         }
     }
@@ -176,25 +470,64 @@ const shared_vec<WormHole> NaiveWorldIndex::queryWormHoles(
 }
 
 const shared_vec<Artifact> NaiveWorldIndex::queryArtifacts(
-    const Matrix& position, f64 radius, f64 t_u
+    const Vec2& position, f64 radius, f64 t_u
 ) const {
     shared_vec<Artifact> result;
+    f64 radius2 = radius * radius;
     for (const auto& art : world_data_.artifacts()) {
         auto art_pos = art->position;
-        if (MathConfig::normp(art_pos - position, 2) <= radius) {
+        if (MathConfig::distSq(art_pos, position) <= radius2) {
             result.push_back(art);
         }
     }
     return result;
 }
 
+void NaiveWorldIndex::visitCelestials(
+    const Vec2& position, f64 radius, f64 t_u,
+    FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+) const {
+    f64 radius2 = radius * radius;
+    const auto& bodies = world_data_.bodies();
+    world_data_.forEachBody([&](const auto& body) {
+        auto body_pos = body.pos(t_u);
+        if (MathConfig::distSq(body_pos, position) <= radius2) {
+            visit(*bodies[body.index], body_pos);
+        }
+    });
+}
+
+void NaiveWorldIndex::visitWormHoles(
+    const Vec2& position, f64 radius, f64,
+    FunctionRef<void(const WormHole&)> visit
+) const {
+    f64 radius2 = radius * radius;
+    for (const auto& wh : world_data_.wormholes()) {
+        if (MathConfig::distSq(wh->entry, position) <= radius2) {
+            visit(*wh);
+        }
+    }
+}
+
+void NaiveWorldIndex::visitArtifacts(
+    const Vec2& position, f64 radius, f64,
+    FunctionRef<void(const Artifact&)> visit
+) const {
+    f64 radius2 = radius * radius;
+    for (const auto& art : world_data_.artifacts()) {
+        if (MathConfig::distSq(art->position, position) <= radius2) {
+            visit(*art);
+        }
+    }
+}
+
 // ---------------- SimpleTimePolicy ----------------
 
 SimpleTimePolicy::SimpleTimePolicy(
     const EnvironmentModel& env_model, f64 tmax, f64 dt_u
 ) : SimpleTimePolicy::TimePolicy(env_model, tmax, dt_u) {}
 
-f64 SimpleTimePolicy::toProper(f64 dt_u, const Matrix& position, const Matrix& velocity, f64 t_u) const {
+f64 SimpleTimePolicy::toProper(f64 dt_u, const Vec2& position, const Vec2& velocity, f64 t_u) const {
     auto f = [&](f64 tau, f64 t_ui) {
         return env_model_.invGamma(position, velocity, t_ui);
     };
@@ -202,7 +535,7 @@ f64 SimpleTimePolicy::toProper(f64 dt_u, const Matrix& position, const Matrix& v
     return MathConfig::rk4Integrate<f64>(0.0f, t_u, dt_u, f);
 }
 
-f64 SimpleTimePolicy::toGlobal(f64 dt_p, const Matrix& position, const Matrix& velocity, f64 t_u) const {
+f64 SimpleTimePolicy::toGlobal(f64 dt_p, const Vec2& position, const Vec2& velocity, f64 t_u) const {
     auto f = [&](f64 t_ui, f64 tau) {
         return env_model_.gamma(position, velocity, t_ui);
     };
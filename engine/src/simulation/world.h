@@ -6,12 +6,95 @@
 #include <ranges>
 #include <memory>
 #include <algorithm>
+#include <optional>
+#include <utility>
 
 #include "utils/types.h"
 #include "utils/math.h"
 #include "utils/matrix.h"
+#include "utils/linalg.h"
 #include "utils/helpers.h"
+#include "utils/per_thread.h"
 #include "simulation/models.h"
+#include "simulation/body_soa.h"
+#include "simulation/field_grid.h"
+
+/**
+ * Maps entity ids to their position in an entity vector.
+ * Uses a dense table indexed by id when the ids are compact, and a hash map
+ * when they are sparse. Immutable after construction, so concurrent lookups
+ * are safe.
+ * Rep-inv: exactly one of dense_ and sparse_ is in use (dense_ iff is_dense_);
+ *   every stored slot is < the size of the indexed vector.
+ */
+class IdIndex {
+public:
+    static constexpr u32 NONE = static_cast<u32>(-1);
+
+    IdIndex() = default;
+
+    /**
+     * Pre: entity ids are unique. Throws std::runtime_error otherwise.
+     */
+    template <typename T>
+    explicit IdIndex(const shared_vec<T>& entities) {
+        u32 max_id = 0;
+        for (const auto& entity : entities) {
+            max_id = std::max(max_id, entity->id);
+        }
+        // Dense while the table stays within a small multiple of the entity count.
+        is_dense_ = entities.empty() || max_id < 4 * entities.size() + 64;
+        if (is_dense_) {
+            dense_.assign(entities.empty() ? 0 : max_id + 1, NONE);
+        }
+        for (u32 slot = 0; slot < entities.size(); ++slot) {
+            u32 id = entities[slot]->id;
+            bool fresh = is_dense_
+                ? std::exchange(dense_[id], slot) == NONE
+                : sparse_.emplace(id, slot).second;
+            req(fresh, "Duplicate entity id " + std::to_string(id) + ".");
+        }
+    }
+
+    /**
+     * Returns the slot of the entity with the given id, or NONE.
+     */
+    inline u32 find(u32 id) const {
+        if (is_dense_) {
+            return id < dense_.size() ? dense_[id] : NONE;
+        }
+        auto it = sparse_.find(id);
+        return it != sparse_.end() ? it->second : NONE;
+    }
+
+    inline bool isDense() const { return is_dense_; }
+
+private:
+    bool is_dense_ = true;
+    std::vector<u32> dense_;
+    umap<u32, u32> sparse_;
+};
+
+/**
+ * Axis-aligned box [lo.x, hi.x] x [lo.y, hi.y].
+ * AF: the empty box when lo.x > hi.x (as default-constructed).
+ */
+struct Bounds {
+    Vec2 lo = Vec2(MathConfig::infinity, MathConfig::infinity);
+    Vec2 hi = Vec2(-MathConfig::infinity, -MathConfig::infinity);
+
+    /**
+     * Grows the box to cover the disc of the given radius around p.
+     */
+    inline void expand(const Vec2& p, f64 radius = 0.0f) {
+        lo = Vec2(std::min(lo.x, p.x - radius), std::min(lo.y, p.y - radius));
+        hi = Vec2(std::max(hi.x, p.x + radius), std::max(hi.y, p.y + radius));
+    }
+
+    inline bool contains(const Vec2& p) const {
+        return p.x >= lo.x && p.x <= hi.x && p.y >= lo.y && p.y <= hi.y;
+    }
+};
 
 /**
  * Defines the world in which the simulation takes place.
@@ -27,21 +110,99 @@ public:
     );
 
     /**
-     * Returns the entities of the specified type.
-     * If id is provided (not -1), returns only the entity with that id.
-     * Elsewise, returns all entities of that type.
+     * Returns all entities of the specified type.
+     */
+
+    inline const shared_vec<CelestialBody>& bodies() const { return bodies_; }
+    inline const shared_vec<WormHole>& wormholes() const { return wormholes_; }
+    inline const shared_vec<Artifact>& artifacts() const { return artifacts_; }
+
+    /**
+     * Returns the entity of the specified type with the given id in O(1),
+     * or nullptr if there is none. Safe to call concurrently.
+     * Post: the pointer stays valid for the lifetime of this WorldData.
+     */
+
+    const CelestialBody* body(u32 id) const;
+    const WormHole* wormhole(u32 id) const;
+    const Artifact* artifact(u32 id) const;
+
+    /**
+     * Bodies partitioned by concrete kind. Together they hold every body of
+     * bodies() exactly once. A TabulatedTrajectory over an EllipticalOrbit
+     * counts as elliptical and is evaluated through its source orbit, which
+     * is exact and keeps the vectorized BodySoA path.
      */
 
-    const shared_vec<CelestialBody>& bodies(i32 id = -1) const;
-    const shared_vec<WormHole>& wormholes(i32 id = -1) const;
-    const shared_vec<Artifact>& artifacts(i32 id = -1) const;
+    inline std::span<const StationaryBodyData> stationaryBodies() const { return stationary_; }
+    inline std::span<const EllipticalBodyData> ellipticalBodies() const { return elliptical_; }
+    inline std::span<const OtherBodyData> otherBodies() const { return other_; }
+
+    /**
+     * Calls visit(body) for every body, one kind at a time, with the concrete
+     * record type, so visit is instantiated and inlined per kind.
+     * Pre: visit is callable with each of StationaryBodyData, EllipticalBodyData
+     *   and OtherBodyData.
+     */
+    template <typename Visitor>
+    inline void forEachBody(Visitor&& visit) const {
+        for (const auto& body : stationary_) { visit(body); }
+        for (const auto& body : elliptical_) { visit(body); }
+        for (const auto& body : other_) { visit(body); }
+    }
+
+    /**
+     * Returns true iff pred(body) holds for some body; stops at the first match.
+     */
+    template <typename Predicate>
+    inline bool anyBody(Predicate&& pred) const {
+        return std::ranges::any_of(stationary_, pred) ||
+               std::ranges::any_of(elliptical_, pred) ||
+               std::ranges::any_of(other_, pred);
+    }
+
+    /**
+     * Returns the structure-of-arrays snapshot of bodies(), built once at construction.
+     */
+    inline const BodySoA& bodySoA() const { return body_soa_; }
 
     inline f64 max_radius() const { return max_radius_; }
+
+    /**
+     * Aggregates computed once at construction.
+     * maxBodyRadius() is the largest body radius (0 without bodies).
+     * bodyBounds() covers every body disc at all times: exactly for stationary
+     *   bodies, by the orbit's circumscribed circle for elliptical ones, and
+     *   by [-(max_radius + maxBodyRadius()), max_radius + maxBodyRadius()]^2
+     *   once any other kind is present.
+     * bounds() covers bodyBounds(), wormhole entries and exits, and artifacts.
+     */
+
+    inline f64 maxBodyRadius() const { return max_body_radius_; }
+    inline const Bounds& bodyBounds() const { return body_bounds_; }
+    inline const Bounds& bounds() const { return bounds_; }
 private:
     shared_vec<CelestialBody> bodies_;
     shared_vec<WormHole> wormholes_;
     shared_vec<Artifact> artifacts_;
+    std::vector<StationaryBodyData> stationary_;
+    std::vector<EllipticalBodyData> elliptical_;
+    std::vector<OtherBodyData> other_;
+    BodySoA body_soa_;
     f64 max_radius_;
+    f64 max_body_radius_ = 0.0f;
+    Bounds body_bounds_, bounds_;
+    IdIndex body_ids_, wormhole_ids_, artifact_ids_;
+};
+
+/**
+ * Gravitational field quantities at one point and time, as returned by
+ * EnvironmentModel::evaluate.
+ */
+struct FieldSample {
+    Vec2 acceleration;  // gravity()
+    f64 potential;      // potential()
+    f64 gamma;          // gamma()
 };
 
 /**
@@ -53,44 +214,145 @@ public:
 
     /**
      * Returns the gravitational acceleration at the given position and global time.
-     * Pre: position is a 2x1 matrix representing (x, y) coordinates.
-     * Post: returns a 2x1 matrix representing the (gx, gy) components
+     * Pre: position represents (x, y) coordinates.
+     * Post: returns a 2D vector representing the (gx, gy) components
      */
-    virtual Matrix gravity(
-        const Matrix& position, f64 t_u
+    virtual Vec2 gravity(
+        const Vec2& position, f64 t_u
     ) const = 0;
     /**
      * Returns the gravitational potential at the given position and global time.
-     * Pre: position is a 2x1 matrix representing (x, y) coordinates
+     * Pre: position represents (x, y) coordinates
      * Post: returns the gravitational potential (a scalar)
      */
     virtual f64 potential(
-        const Matrix& position, f64 t_u
+        const Vec2& position, f64 t_u
     ) const = 0;
     /**
      * Returns the time dilation factor (gamma) at the given position, velocity, and global time.
-     * Pre: position and velocity are 2x1 matrices representing (x, y) and (vx, vy) respectively.
+     * Pre: position and velocity represent (x, y) and (vx, vy) respectively.
      * Post: returns the time dilation factor (a scalar) (dt_global / dt_proper)
      */
     virtual f64 gamma(
-        const Matrix& position, const Matrix& velocity, f64 t_u
+        const Vec2& position, const Vec2& velocity, f64 t_u
     ) const = 0;
 
     /**
      * Returns the inverse of the time dilation factor (1 / gamma).
-     * Pre: position and velocity are 2x1 matrices representing (x, y) and (vx, vy) respectively.
+     * Pre: position and velocity represent (x, y) and (vx, vy) respectively.
      * Post: returns the inverse time dilation factor (a scalar) (dt_proper / dt_global)
      */
     virtual f64 invGamma(
-        const Matrix& position, const Matrix& velocity, f64 t_u
+        const Vec2& position, const Vec2& velocity, f64 t_u
     ) const = 0;
 
+    /**
+     * Returns gravity, potential and gamma at the given state together.
+     * Implementations should share the work over bodies between them; the
+     * default calls the three queries separately.
+     * Post: equals {gravity(position, t_u), potential(position, t_u),
+     *   gamma(position, velocity, t_u)} up to rounding.
+     */
+    inline virtual FieldSample evaluate(
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const {
+        return {
+            gravity(position, t_u),
+            potential(position, t_u),
+            gamma(position, velocity, t_u)
+        };
+    }
+
+    /**
+     * Writes the field at each query point (xs[k], ys[k]) at global time t_u
+     * into (ax[k], ay[k]), and the potential into phi[k] unless phi is empty.
+     * The default queries the points one by one.
+     * Pre: xs, ys, ax, ay (and phi, if not empty) have the same size.
+     * Post: equals gravity() and potential() per point up to rounding.
+     */
+    virtual void gravityBatch(
+        std::span<const f64> xs, std::span<const f64> ys, f64 t_u,
+        std::span<f64> ax, std::span<f64> ay, std::span<f64> phi
+    ) const;
+
+    /**
+     * Writes evaluate() of each state (xs[k], ys[k]), (vxs[k], vys[k]) at
+     * global time ts[k] into out[k]. The default evaluates the states one by one.
+     * Pre: all spans have the same size.
+     */
+    virtual void evaluateBatch(
+        std::span<const f64> xs, std::span<const f64> ys,
+        std::span<const f64> vxs, std::span<const f64> vys,
+        std::span<const f64> ts, std::span<FieldSample> out
+    ) const;
+
+    /**
+     * Advances the free-falling state (x, v) from global time t_u by dt_u in
+     * closed form, for models that admit one.
+     * Returns false, leaving x and v unchanged, if the model cannot; the
+     * default never can.
+     */
+    inline virtual bool propagateCoast(Vec2&, Vec2&, f64, f64) const {
+        return false;
+    }
+
+    /**
+     * Drops any memoized per-time state. Called at the start of every node
+     * expansion; queries stay correct without it, but caches stay small.
+     */
+    inline virtual void resetCache() const {}
+
     virtual ~EnvironmentModel() = default;
 
 protected:
+    /**
+     * Weak-field inverse time dilation, dt_proper / dt_global, from the
+     * potential phi and the squared speed v2.
+     */
+    static inline f64 weakFieldInvGamma(f64 phi, f64 v2) {
+        auto c2 = MathConfig::c * MathConfig::c;
+        return 1.0 + phi / c2 - v2 / (2.0 * c2);
+    }
+
     const WorldData& world_data_;
 };
 
+/**
+ * The kinds of entity a WorldIndex query can target.
+ */
+enum class EntityKind {
+    Celestial,
+    WormHole,
+    Artifact
+};
+
+/**
+ * Restricts the entities a nearest-neighbour query may return.
+ */
+struct QueryFilter {
+    EntityKind kind = EntityKind::Artifact;
+    const uset<u32>* exclude = nullptr;         // ids to skip, e.g. collected artifacts
+    f64 max_distance = MathConfig::infinity;
+
+    inline bool admits(u32 id) const {
+        return !exclude || !exclude->contains(id);
+    }
+};
+
+/**
+ * An entity found by a nearest-neighbour query, and its distance from the
+ * query point (to the centre of bodies, the entry of wormholes).
+ */
+struct Neighbor {
+    u32 id;
+    f64 distance;
+
+    // Orders by distance, then id.
+    inline bool operator<(const Neighbor& other) const {
+        return distance < other.distance || (distance == other.distance && id < other.id);
+    }
+};
+
 /**
  * Spatial index for efficient querying of entities in the world.
  */
@@ -100,28 +362,81 @@ public:
 
     /**
      * Returns entities within the specified radius of the given position at time t_u.
-     * Pre: position is a 2x1 matrix representing (x, y) coordinates
+     * Pre: position represents (x, y) coordinates
      * Post: returns spans of entities within the radius
      */
     
     virtual const shared_vec<CelestialBody> queryCelestials(
-        const Matrix& position,
+        const Vec2& position,
         f64 radius, 
         f64 t_u
     ) const = 0;
     
     virtual const shared_vec<WormHole> queryWormHoles(
-        const Matrix& position,
+        const Vec2& position,
         f64 radius,
         f64 t_u
     ) const = 0;
     
     virtual const shared_vec<Artifact> queryArtifacts(
-        const Matrix& position,
+        const Vec2& position,
         f64 radius,
         f64 t_u
     ) const = 0;
 
+    /**
+     * Returns the entity of filter.kind closest to position at time t_u among
+     * those admitted by filter, or std::nullopt if there is none.
+     * The default scans every entity of that kind.
+     */
+    virtual std::optional<Neighbor> nearest(
+        const Vec2& position,
+        f64 t_u,
+        const QueryFilter& filter
+    ) const;
+
+    /**
+     * Returns up to k entities of filter.kind closest to position at time t_u
+     * among those admitted by filter, by increasing (distance, id).
+     * The default scans every entity of that kind.
+     */
+    virtual std::vector<Neighbor> kNearest(
+        const Vec2& position,
+        size_t k,
+        f64 t_u,
+        const QueryFilter& filter
+    ) const;
+
+    /**
+     * Visitor forms of the queries above: call visit once per entity they
+     * would return, in unspecified order, with a non-owning reference valid
+     * for the lifetime of the WorldData. Celestial visits also receive the
+     * body's position at t_u.
+     * The defaults forward to the queries; indexes override them so that a
+     * query neither allocates nor touches reference counts.
+     */
+
+    virtual void visitCelestials(
+        const Vec2& position,
+        f64 radius,
+        f64 t_u,
+        FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+    ) const;
+
+    virtual void visitWormHoles(
+        const Vec2& position,
+        f64 radius,
+        f64 t_u,
+        FunctionRef<void(const WormHole&)> visit
+    ) const;
+
+    virtual void visitArtifacts(
+        const Vec2& position,
+        f64 radius,
+        f64 t_u,
+        FunctionRef<void(const Artifact&)> visit
+    ) const;
+
     virtual ~WorldIndex() = default;
 
 protected:
@@ -136,10 +451,10 @@ public:
     TimePolicy(const EnvironmentModel& env_model, f64 tmax, f64 dt_u = 1.0f);
 
     virtual f64 toProper(
-        f64 dt_u, const Matrix& position, const Matrix& velocity, f64 t_u
+        f64 dt_u, const Vec2& position, const Vec2& velocity, f64 t_u
     ) const = 0;
     virtual f64 toGlobal(
-        f64 dt_p, const Matrix& position, const Matrix& velocity, f64 t_u
+        f64 dt_p, const Vec2& position, const Vec2& velocity, f64 t_u
     ) const = 0;
     
     inline virtual f64 tmax() const { return tmax_; }
@@ -157,7 +472,7 @@ protected:
 // --------------------- Frame Representations ---------------------
 
 struct ShipFrame {
-    Matrix x, v;
+    Vec2 x, v;
     f64 fuel;
     f64 t_p; 
     uset<u32> collected_artifacts;
@@ -165,22 +480,22 @@ struct ShipFrame {
 
 struct BodyFrame {
     int id;
-    Matrix x;
+    Vec2 x, v;
     f64 radius;
     f64 mass;
 };
 
 struct WormHoleFrame {
     int id;
-    Matrix entry;
-    Matrix exit;
+    Vec2 entry;
+    Vec2 exit;
     f64 t_open;
     f64 t_close;
 };
 
 struct ArtifactFrame {
     int id;
-    Matrix position;
+    Vec2 position;
 };
 
 struct WorldFrame {
@@ -196,22 +511,109 @@ struct WorldFrame {
  */
 namespace ref {
 
+/**
+ * Direct summation over all bodies.
+ * With cache_quantum > 0, body positions are memoized per global time rounded
+ * to a multiple of cache_quantum, so the actions of one expansion, whose RK
+ * stages land at nearly the same t_u, evaluate the ephemeris once. Bodies are
+ * then placed at the rounded time, off by at most body speed * cache_quantum / 2.
+ * Each thread has its own cache, so concurrent queries stay safe; times too
+ * far out to round to an integer multiple bypass it.
+ * With static_grid_cells > 0, stationary bodies are served from a
+ * StaticFieldGrid over [-max_radius, max_radius]^2, exact within near_radii
+ * body radii, and only moving bodies are summed directly.
+ */
 class ConcreteEnvironment : public ::EnvironmentModel {
 public:
-    explicit ConcreteEnvironment(const WorldData&);
+    struct CacheStats {
+        u64 hits = 0;
+        u64 misses = 0;
+    };
+
+    explicit ConcreteEnvironment(
+        const WorldData&, f64 cache_quantum = 0.0f,
+        u32 static_grid_cells = 0, f64 near_radii = 4.0f
+    );
 
-    Matrix gravity(
-        const Matrix& position, f64 t_u
+    Vec2 gravity(
+        const Vec2& position, f64 t_u
     ) const override;
     f64 potential(
-        const Matrix& position, f64 t_u
+        const Vec2& position, f64 t_u
     ) const override;
     f64 gamma(
-        const Matrix& position, const Matrix& velocity, f64 t_u
+        const Vec2& position, const Vec2& velocity, f64 t_u
     ) const override;
     f64 invGamma(
-        const Matrix& position, const Matrix& velocity, f64 t_u
+        const Vec2& position, const Vec2& velocity, f64 t_u
+    ) const override;
+    FieldSample evaluate(
+        const Vec2& position, const Vec2& velocity, f64 t_u
     ) const override;
+
+    /**
+     * Runs the simd gravity kernel over the query points, with the same
+     * operations per point as evaluate(), so the results agree bit-for-bit.
+     */
+    void gravityBatch(
+        std::span<const f64> xs, std::span<const f64> ys, f64 t_u,
+        std::span<f64> ax, std::span<f64> ay, std::span<f64> phi
+    ) const override;
+    /**
+     * Runs the kernel once per run of consecutive states whose times place
+     * the bodies identically, so it agrees bit-for-bit with evaluate().
+     */
+    void evaluateBatch(
+        std::span<const f64> xs, std::span<const f64> ys,
+        std::span<const f64> vxs, std::span<const f64> vys,
+        std::span<const f64> ts, std::span<FieldSample> out
+    ) const override;
+
+    /**
+     * Drops the calling thread's cached positions.
+     */
+    void resetCache() const override;
+
+    /**
+     * Hits and misses of the calling thread's cache.
+     */
+    inline const CacheStats& cacheStats() const { return cache_.local().stats; }
+
+private:
+    /**
+     * Returns the body positions at t_u in BodySoA order.
+     * Post: the arrays stay valid until the next call on this instance and
+     *   thread.
+     */
+    std::pair<const f64*, const f64*> positions(f64 t_u) const;
+
+    /**
+     * True iff positions(a) and positions(b) place the bodies identically.
+     */
+    bool sameSnapshot(f64 a, f64 b) const;
+
+    // Bounds the cache between resets.
+    static constexpr size_t MAX_CACHED_TIMES = 1024;
+    // |t_u / cache_quantum_| below this rounds to an i64 key.
+    static constexpr f64 MAX_CACHE_KEY = 0x1p62;
+
+    const f64 cache_quantum_;
+
+    // G * mass per body, in BodySoA order.
+    std::vector<f64> gm_;
+
+    // Bodies [0, first_body_) of the BodySoA are covered by static_grid_.
+    std::optional<StaticFieldGrid> static_grid_;
+    size_t first_body_ = 0;
+
+    // Rep-inv: slots maps round(t_u / cache_quantum_) to a slot k, whose
+    //   positions are xs/ys[k * n, (k + 1) * n) for n bodies.
+    struct PositionCache {
+        umap<i64, size_t> slots;
+        std::vector<f64> xs, ys;
+        CacheStats stats;
+    };
+    PerThread<PositionCache> cache_;
 };
 
 class NaiveWorldIndex : public ::WorldIndex {
@@ -219,13 +621,26 @@ public:
     explicit NaiveWorldIndex(const WorldData& world_data);
 
     const shared_vec<CelestialBody> queryCelestials(
-        const Matrix& position, f64 radius, f64 t_u
+        const Vec2& position, f64 radius, f64 t_u
     ) const override;
     const shared_vec<WormHole> queryWormHoles(
-        const Matrix& position, f64 radius, f64 t_u
+        const Vec2& position, f64 radius, f64 t_u
     ) const override;
     const shared_vec<Artifact> queryArtifacts(
-        const Matrix& position, f64 radius, f64 t_u
+        const Vec2& position, f64 radius, f64 t_u
+    ) const override;
+
+    void visitCelestials(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const CelestialBody&, const Vec2&)> visit
+    ) const override;
+    void visitWormHoles(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const WormHole&)> visit
+    ) const override;
+    void visitArtifacts(
+        const Vec2& position, f64 radius, f64 t_u,
+        FunctionRef<void(const Artifact&)> visit
     ) const override;
 };
 
@@ -234,10 +649,10 @@ public:
     SimpleTimePolicy(const EnvironmentModel& env_model, f64 tmax, f64 dt_u = 1.0f);
 
     f64 toProper(
-        f64 dt_u, const Matrix& position, const Matrix& velocity, f64 t_u
+        f64 dt_u, const Vec2& position, const Vec2& velocity, f64 t_u
     ) const override;
     f64 toGlobal(
-        f64 dt_p, const Matrix& position, const Matrix& velocity, f64 t_u
+        f64 dt_p, const Vec2& position, const Vec2& velocity, f64 t_u
     ) const override;
 };
 
@@ -0,0 +1,15 @@
+#include "arena.h"
+
+MemoryArena::MemoryArena(size_t initial_bytes)
+    : initial_(std::make_unique<std::byte[]>(initial_bytes)),
+      pool_(initial_.get(), initial_bytes, std::pmr::new_delete_resource()) {}
+
+ArenaScope::ArenaScope(MemoryArena& arena)
+    : arena_(arena), previous_(MemoryArena::current_) {
+    MemoryArena::current_ = arena.resource();
+}
+
+ArenaScope::~ArenaScope() {
+    MemoryArena::current_ = previous_;
+    arena_.reset();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * A bump allocator for short-lived allocations, e.g. the Matrix temporaries of
+ * one integration step. Allocation is a pointer bump, deallocation is a no-op,
+ * and reset() reclaims everything at once while keeping the initial block.
+ *
+ * Arena-aware containers (SmallBuffer, and so Matrix) bind to
+ * MemoryArena::current() when constructed: the innermost ArenaScope on this
+ * thread, or the global heap outside of any scope.
+ */
+class MemoryArena {
+public:
+    explicit MemoryArena(size_t initial_bytes = 64 * 1024);
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    inline std::pmr::memory_resource* resource() { return &pool_; }
+
+    /**
+     * Frees every allocation made from the arena.
+     * Pre: nothing allocated from the arena is still in use.
+     */
+    inline void reset() { pool_.release(); }
+
+    /**
+     * Returns the memory resource that arena-aware containers should
+     * allocate from on the calling thread.
+     */
+    static inline std::pmr::memory_resource* current() {
+        return current_ ? current_ : std::pmr::get_default_resource();
+    }
+
+private:
+    friend class ArenaScope;
+
+    static inline thread_local std::pmr::memory_resource* current_ = nullptr;
+
+    std::unique_ptr<std::byte[]> initial_;
+    std::pmr::monotonic_buffer_resource pool_;
+};
+
+/**
+ * Makes an arena the current one for the calling thread for the lifetime of
+ * the scope, then restores the previous one and resets the arena.
+ * Containers constructed inside the scope must not outlive it. Moving them out
+ * is safe (see SmallBuffer), but a named return value the compiler constructs
+ * in place is not; copy into containers constructed outside instead.
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(MemoryArena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    MemoryArena& arena_;
+    std::pmr::memory_resource* previous_;
+};
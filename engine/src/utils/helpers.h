@@ -9,6 +9,7 @@
 #include <set>
 #include <iterator>
 #include <functional>
+#include <memory>
 
 #include "utils/types.h"
 
@@ -23,6 +24,37 @@ struct overloaded : ts... {
     using ts::operator()...;
 };
 
+/**
+ * Non-owning, non-allocating reference to a callable, for callbacks through
+ * virtual interfaces where a template cannot be used.
+ * Pre: the referenced callable outlives every call through this reference.
+ */
+template <typename Signature>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+public:
+    template <typename F>
+        requires (!std::same_as<std::remove_cvref_t<F>, FunctionRef> &&
+                  std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& f) noexcept
+        : obj_(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+          call_([] (void* obj, Args... args) -> R {
+              return std::invoke(
+                  *static_cast<std::remove_reference_t<F>*>(obj), std::forward<Args>(args)...
+              );
+          }) {}
+
+    inline R operator()(Args... args) const {
+        return call_(obj_, std::forward<Args>(args)...);
+    }
+
+private:
+    void* obj_;
+    R (*call_)(void*, Args...);
+};
+
 template <typename T>
 inline std::set<T> operator|(const std::set<T>& a, const std::set<T>& b) {
     std::set<T> result;
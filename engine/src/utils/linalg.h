@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <compare>
+#include <vector>
+#include <functional>
+
+#include "utils/types.h"
+#include "utils/helpers.h"
+#include "utils/matrix.h"
+
+/**
+ * Fixed-size 2D column vector used by the simulation hot paths.
+ * Trivially copyable and constexpr-capable; never touches the heap.
+ * Abstraction function:
+ * Vec2(x, y) represents the 2x1 column vector [x; y].
+ * The element at row i is accessed via operator()(i, 0), 0 <= i < 2.
+ */
+struct Vec2 {
+    f64 x = 0.0f, y = 0.0f;
+
+    constexpr Vec2() = default;
+    constexpr Vec2(f64 x, f64 y) : x(x), y(y) {}
+
+    /**
+     * Builds a vector from a list of exactly two values.
+     * Throws std::runtime_error if values.size() != 2.
+     */
+    explicit Vec2(const std::vector<f64>& values) {
+        req(values.size() == 2, "Vector size does not match Vec2 dimensions");
+        x = values[0];
+        y = values[1];
+    }
+
+    /**
+     * Builds a vector from a 2x1 matrix.
+     * Throws std::runtime_error if mat is not 2x1.
+     */
+    explicit Vec2(const Matrix& mat) {
+        req(mat.rows() == 2 && mat.cols() == 1, "Matrix must be of size 2x1");
+        x = mat(0, 0);
+        y = mat(1, 0);
+    }
+
+    inline Matrix toMatrix() const {
+        return Matrix(2, 1, {x, y});
+    }
+
+    constexpr f64& operator()(size_t i, size_t = 0) {
+        return i == 0 ? x : y;
+    }
+
+    constexpr const f64& operator()(size_t i, size_t = 0) const {
+        return i == 0 ? x : y;
+    }
+
+    constexpr size_t rows() const { return 2; }
+    constexpr size_t cols() const { return 1; }
+
+    constexpr std::pair<size_t, size_t> shape() const {
+        return {2, 1};
+    }
+
+    /**
+     * Returns a hash value for the vector.
+     * Matches Matrix::hash() of the equivalent 2x1 matrix.
+     */
+    inline size_t hash() const {
+        size_t seed = 0;
+        seed = hash_combine(seed, std::hash<f64>()(x));
+        seed = hash_combine(seed, std::hash<f64>()(y));
+        seed = hash_combine(seed, std::hash<size_t>()(2));
+        seed = hash_combine(seed, std::hash<size_t>()(1));
+        return seed;
+    }
+
+    constexpr auto operator<=>(const Vec2& other) const = default;
+
+    constexpr Vec2& operator+=(const Vec2& o) { x += o.x; y += o.y; return *this; }
+    constexpr Vec2& operator-=(const Vec2& o) { x -= o.x; y -= o.y; return *this; }
+    constexpr Vec2& operator*=(f64 s) { x *= s; y *= s; return *this; }
+
+    friend constexpr Vec2 operator+(const Vec2& a, const Vec2& b) { return {a.x + b.x, a.y + b.y}; }
+    friend constexpr Vec2 operator-(const Vec2& a, const Vec2& b) { return {a.x - b.x, a.y - b.y}; }
+    friend constexpr Vec2 operator-(const Vec2& a) { return {-a.x, -a.y}; }
+    friend constexpr Vec2 operator*(const Vec2& v, f64 s) { return {v.x * s, v.y * s}; }
+    friend constexpr Vec2 operator*(f64 s, const Vec2& v) { return {v.x * s, v.y * s}; }
+
+    static constexpr Vec2 zero() { return {0.0f, 0.0f}; }
+};
+
+/**
+ * Fixed-size 3x3 matrix, used for 2D affine transformations.
+ * Trivially copyable and constexpr-capable; never touches the heap.
+ * Abstraction function:
+ * data_ stores the 9 elements in row-major order;
+ * the element at row i and column j is accessed via operator()(i, j),
+ * where 0 <= i, j < 3.
+ */
+struct Mat3 {
+    std::array<f64, 9> data_ = {};
+
+    constexpr Mat3() = default;
+    constexpr explicit Mat3(const std::array<f64, 9>& values) : data_(values) {}
+
+    /**
+     * Builds a 3x3 matrix from a general matrix.
+     * Throws std::runtime_error if mat is not 3x3.
+     */
+    explicit Mat3(const Matrix& mat) {
+        req(mat.rows() == 3 && mat.cols() == 3, "Matrix must be of size 3x3");
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                data_[i * 3 + j] = mat(i, j);
+            }
+        }
+    }
+
+    inline Matrix toMatrix() const {
+        return Matrix(3, 3, std::vector<f64>(data_.begin(), data_.end()));
+    }
+
+    constexpr f64& operator()(size_t i, size_t j) { return data_[i * 3 + j]; }
+    constexpr const f64& operator()(size_t i, size_t j) const { return data_[i * 3 + j]; }
+
+    constexpr size_t rows() const { return 3; }
+    constexpr size_t cols() const { return 3; }
+
+    constexpr std::pair<size_t, size_t> shape() const {
+        return {3, 3};
+    }
+
+    constexpr Mat3 T() const {
+        Mat3 result;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                result(j, i) = (*this)(i, j);
+            }
+        }
+        return result;
+    }
+
+    constexpr f64 trace() const {
+        return data_[0] + data_[4] + data_[8];
+    }
+
+    /**
+     * Returns a hash value for the matrix.
+     * Matches Matrix::hash() of the equivalent 3x3 matrix.
+     */
+    inline size_t hash() const {
+        size_t seed = 0;
+        for (const auto& val : data_) {
+            seed = hash_combine(seed, std::hash<f64>()(val));
+        }
+        seed = hash_combine(seed, std::hash<size_t>()(3));
+        seed = hash_combine(seed, std::hash<size_t>()(3));
+        return seed;
+    }
+
+    constexpr auto operator<=>(const Mat3& other) const = default;
+
+    friend constexpr Mat3 operator+(const Mat3& a, const Mat3& b) {
+        Mat3 result;
+        for (size_t k = 0; k < 9; ++k) { result.data_[k] = a.data_[k] + b.data_[k]; }
+        return result;
+    }
+
+    friend constexpr Mat3 operator-(const Mat3& a, const Mat3& b) {
+        Mat3 result;
+        for (size_t k = 0; k < 9; ++k) { result.data_[k] = a.data_[k] - b.data_[k]; }
+        return result;
+    }
+
+    friend constexpr Mat3 operator*(const Mat3& mat, f64 scalar) {
+        Mat3 result;
+        for (size_t k = 0; k < 9; ++k) { result.data_[k] = mat.data_[k] * scalar; }
+        return result;
+    }
+
+    friend constexpr Mat3 operator*(f64 scalar, const Mat3& mat) {
+        return mat * scalar;
+    }
+
+    friend constexpr Mat3 operator*(const Mat3& a, const Mat3& b) {
+        Mat3 result;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                for (size_t k = 0; k < 3; ++k) {
+                    result(i, j) += a(i, k) * b(k, j);
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Applies the affine transformation to a point.
+     * Equivalent to fromHomogeneous(M * toHomogeneous(p)).
+     * Pre: the transformation does not map p to w == 0.
+     */
+    friend constexpr Vec2 operator*(const Mat3& m, const Vec2& p) {
+        f64 x = m(0, 0) * p.x + m(0, 1) * p.y + m(0, 2);
+        f64 y = m(1, 0) * p.x + m(1, 1) * p.y + m(1, 2);
+        f64 w = m(2, 0) * p.x + m(2, 1) * p.y + m(2, 2);
+        return (w == 1.0f) ? Vec2{x, y} : Vec2{x / w, y / w};
+    }
+
+    static constexpr Mat3 eye() {
+        return Mat3({1.0f, 0.0f, 0.0f,
+                     0.0f, 1.0f, 0.0f,
+                     0.0f, 0.0f, 1.0f});
+    }
+
+    static constexpr Mat3 zero() {
+        return Mat3();
+    }
+
+    /* ****************************************************************
+     * Following functions create 3x3 affine transformation matrices.
+     *************************************************************** */
+
+    static constexpr Mat3 translate2d(f64 tx, f64 ty) {
+        return Mat3({1.0f, 0.0f, tx,
+                     0.0f, 1.0f, ty,
+                     0.0f, 0.0f, 1.0f});
+    }
+
+    static inline Mat3 rotate2d(f64 angle_rad) {
+        f64 c = std::cos(angle_rad);
+        f64 s = std::sin(angle_rad);
+        return Mat3({c,    -s,    0.0f,
+                     s,     c,    0.0f,
+                     0.0f,  0.0f, 1.0f});
+    }
+
+    static constexpr Mat3 scale2d(f64 sx, f64 sy) {
+        return Mat3({sx,   0.0f, 0.0f,
+                     0.0f, sy,   0.0f,
+                     0.0f, 0.0f, 1.0f});
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Vec2>);
+static_assert(std::is_trivially_copyable_v<Mat3>);
+
+template <>
+struct std::hash<Vec2> {
+    inline size_t operator()(const Vec2& v) const {
+        return v.hash();
+    }
+};
+
+template <>
+struct std::hash<Mat3> {
+    inline size_t operator()(const Mat3& mat) const {
+        return mat.hash();
+    }
+};
@@ -5,20 +5,33 @@
 #include <limits>
 #include <concepts>
 #include "utils/matrix.h"
+#include "utils/linalg.h"
 #include "utils/types.h"
 
+/**
+ * Numerical integration schemes selectable from configuration.
+ */
+enum class IntegratorKind {
+    RK4,                // fixed-step classic Runge-Kutta
+    DormandPrince45,    // adaptive embedded Runge-Kutta 5(4)
+    VelocityVerlet,     // symplectic, 2nd order; conservative (coasting) motion only
+    Yoshida4,           // symplectic, 4th order; conservative (coasting) motion only
+    Kepler              // analytic two-body arcs; coasting only, needs EnvironmentModel::propagateCoast
+};
+
 /**
  * The configuration struct for math utilities.
  * Provides constants, helpers, tolerances, and settings for mathematical operations.
  */
 struct MathConfig {
     static constexpr f64 epsilon = 1e-12f; 
-    static constexpr f64 pi = 3.14159265358979323846f;
+    static constexpr f64 pi = 3.14159265358979323846;
     static constexpr f64 infinity = std::numeric_limits<f64>::infinity();
     static constexpr f64 G = 6.67430e-11f * 1e-9f; // G in km^3 kg^-1 s^-2
     static constexpr f64 c = 299792.458f; // Speed of light in km/s
     static constexpr f64 DEG2RAD = pi / 180.0f;
     static constexpr f64 RAD2DEG = 180.0f / pi;
+    static constexpr int NORM_INF = 0; // p selecting the max-norm in norm<P> / normp
 
     MathConfig() = default;
     virtual ~MathConfig() = default;
@@ -61,6 +74,15 @@ struct MathConfig {
         return angle;
     }
 
+    /**
+     * Computes sin(x) and cos(x) together; the compiler fuses the pair into
+     * a single sincos evaluation.
+     */
+    static inline void sincos(f64 x, f64& s, f64& c)  {
+        s = std::sin(x);
+        c = std::cos(x);
+    }
+
     static inline f64 clamp(f64 value, f64 min_val, f64 max_val = MathConfig::infinity)  {
         return std::max(min_val, std::min(value, max_val));
     }
@@ -71,15 +93,42 @@ struct MathConfig {
 
     // Operations related to vectors
 
-    static inline f64 normp(Matrix v, int p = 2)  {
+    /**
+     * Returns the L1, L2 or max-norm (P == NORM_INF) of the elements of v,
+     * specialized at compile time.
+     */
+    template <int P>
+    static inline f64 norm(ConstMatrixView v)  {
+        static_assert(P == 1 || P == 2 || P == NORM_INF, "Only L1, L2 and Linf norms are specialized.");
+        f64 acc = 0.0f;
+        for (size_t i = 0; i < v.rows(); ++i) {
+            for (size_t j = 0; j < v.cols(); ++j) {
+                f64 x = v(i, j);
+                if constexpr (P == 1) { acc += std::fabs(x); }
+                else if constexpr (P == 2) { acc += x * x; }
+                else { acc = std::max(acc, std::fabs(x)); }
+            }
+        }
+        if constexpr (P == 2) { return std::sqrt(acc); }
+        return acc;
+    }
+
+    static inline f64 normp(ConstMatrixView v, int p = 2)  {
+        switch (p) {
+            case 1:        return norm<1>(v);
+            case 2:        return norm<2>(v);
+            case NORM_INF: return norm<NORM_INF>(v);
+        }
         f64 sum = 0.0f;
         for (size_t i = 0; i < v.rows(); ++i) {
-            sum += std::pow(std::fabs(v(i, 0)), p);
+            for (size_t j = 0; j < v.cols(); ++j) {
+                sum += std::pow(std::fabs(v(i, j)), p);
+            }
         }
         return std::pow(sum, 1.0f / p);
     }
 
-    static inline Matrix normalized(Matrix v)  {
+    static inline Matrix normalized(ConstMatrixView v)  {
         auto n = normp(v, 2);
         if (MathConfig::floatEquals(n, 0.0f)) {
             throw std::invalid_argument("Cannot normalize zero vector.");
@@ -87,25 +136,452 @@ struct MathConfig {
         return v * (1.0f / n);
     }
 
-    static inline f64 dot(Matrix a, Matrix b)  {
-        return (a.T() * b)(0, 0);
+    /**
+     * Returns the sum of the element-wise products of a and b,
+     * i.e. a^T b for column vectors, without forming the transpose.
+     * Throws std::invalid_argument if the shapes differ.
+     */
+    static inline f64 dot(ConstMatrixView a, ConstMatrixView b)  {
+        if (a.shape() != b.shape()) {
+            throw std::invalid_argument("Dot product requires matrices of the same shape.");
+        }
+        f64 sum = 0.0f;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                sum += a(i, j) * b(i, j);
+            }
+        }
+        return sum;
+    }
+
+    // Lazy expressions are evaluated once and then handled as views.
+
+    template <MatrixExpression E>
+        requires (!std::is_convertible_v<const E&, ConstMatrixView>)
+    static inline f64 normp(const E& v, int p = 2)  {
+        return normp(Matrix(v), p);
+    }
+
+    template <MatrixExpression E>
+        requires (!std::is_convertible_v<const E&, ConstMatrixView>)
+    static inline Matrix normalized(const E& v)  {
+        return normalized(Matrix(v));
+    }
+
+    template <int P>
+    static inline f64 norm(const Vec2& v)  {
+        static_assert(P == 1 || P == 2 || P == NORM_INF, "Only L1, L2 and Linf norms are specialized.");
+        if constexpr (P == 1) { return std::fabs(v.x) + std::fabs(v.y); }
+        else if constexpr (P == 2) { return std::sqrt(v.x * v.x + v.y * v.y); }
+        else { return std::max(std::fabs(v.x), std::fabs(v.y)); }
+    }
+
+    static inline f64 normp(const Vec2& v, int p = 2)  {
+        switch (p) {
+            case 1:        return norm<1>(v);
+            case 2:        return norm<2>(v);
+            case NORM_INF: return norm<NORM_INF>(v);
+        }
+        f64 sum = std::pow(std::fabs(v.x), p) + std::pow(std::fabs(v.y), p);
+        return std::pow(sum, 1.0f / p);
+    }
+
+    /**
+     * Squared L2 norm. Compare it against squared radii to avoid the sqrt.
+     */
+    static inline f64 norm2Sq(const Vec2& v)  {
+        return v.x * v.x + v.y * v.y;
+    }
+
+    static inline f64 distSq(const Vec2& a, const Vec2& b)  {
+        return norm2Sq(a - b);
+    }
+
+    static inline f64 dist(const Vec2& a, const Vec2& b)  {
+        return std::sqrt(distSq(a, b));
+    }
+
+    /**
+     * Reciprocal square root, 1 / sqrt(x).
+     */
+    static inline f64 rsqrt(f64 x)  {
+        return 1.0f / std::sqrt(x);
+    }
+
+    static inline Vec2 normalized(const Vec2& v)  {
+        auto n2 = norm2Sq(v);
+        if (n2 < epsilon * epsilon) {
+            throw std::invalid_argument("Cannot normalize zero vector.");
+        }
+        return v * rsqrt(n2);
+    }
+
+    static inline f64 dot(const Vec2& a, const Vec2& b)  {
+        return a.x * b.x + a.y * b.y;
     }
 
     // Numerical integration using 4th-order Runge-Kutta method
 
+    /**
+     * Stage buffers of rk4Step. Keep one alive across steps so that
+     * heap-backed state types (e.g. Matrix) reuse their storage.
+     */
     template <typename T>
+    struct RK4Workspace {
+        T k1, k2, k3, k4, tmp;
+    };
+
+    /**
+     * Advances x in place by one RK4 step of size dt from time t.
+     * f(x, t, out) writes dx/dt into out; it is taken by its own type so
+     * the call can be inlined. T needs x + y and x * f64.
+     */
+    template <typename T, typename F>
+        requires std::invocable<F&, const T&, f64, T&>
+    static inline void rk4Step(
+        T& x,
+        f64 t,
+        f64 dt,
+        F&& f,
+        RK4Workspace<T>& ws
+    )  {
+        f(x, t, ws.k1);
+        ws.tmp = x + ws.k1 * (dt / 2.0);
+        f(ws.tmp, t + dt / 2.0, ws.k2);
+        ws.tmp = x + ws.k2 * (dt / 2.0);
+        f(ws.tmp, t + dt / 2.0, ws.k3);
+        ws.tmp = x + ws.k3 * dt;
+        f(ws.tmp, t + dt, ws.k4);
+
+        x = x + (ws.k1 + ws.k2 * 2.0 + ws.k3 * 2.0 + ws.k4) * (dt / 6.0);
+    }
+
+    /**
+     * Returns x0 advanced by one RK4 step, for derivatives of the form
+     * f(x, t) -> dx/dt.
+     */
+    template <typename T, typename F>
+        requires std::invocable<F&, const T&, f64>
     static inline T rk4Integrate(
         const T& x0,
-        double t, 
-        double dt,
-        const std::function<T(const T&, double)>& f
+        f64 t, 
+        f64 dt,
+        F&& f
+    )  {
+        RK4Workspace<T> ws;
+        T x = x0;
+        rk4Step(x, t, dt, [&f] (const T& s, f64 ts, T& out) { out = f(s, ts); }, ws);
+        return x;
+    }
+
+    // Adaptive integration using the Dormand-Prince 5(4) method
+
+    /**
+     * Stage buffers of dp45Integrate, reusable across calls.
+     */
+    template <typename T>
+    struct DP45Workspace {
+        T k1, k2, k3, k4, k5, k6, k7, tmp, y_new, err;
+    };
+
+    /**
+     * Continuous extension of one accepted Dormand-Prince step over [t0, t0 + h],
+     * accurate to 4th order (Hairer, Norsett & Wanner, "Solving ODEs I").
+     */
+    template <typename T>
+    struct DP45Dense {
+        f64 t0, h;
+        T r1, r2, r3, r4, r5;
+
+        /**
+         * Returns the interpolated state at time t. Pre: t in [t0, t0 + h].
+         */
+        inline T at(f64 t) const {
+            f64 theta = (t - t0) / h;
+            f64 theta1 = 1.0 - theta;
+            return r1 + (r2 + (r3 + (r4 + r5 * theta1) * theta) * theta1) * theta;
+        }
+    };
+
+    struct DP45Stats {
+        u32 accepted = 0;
+        u32 rejected = 0;
+        f64 last_h = 0.0f;
+        bool completed = false;
+    };
+
+    /**
+     * Step-size controller settings for dp45Integrate.
+     */
+    struct DP45Options {
+        f64 h0;                     // initial step size, e.g. the whole interval
+        u32 max_steps = 10000;      // accepted + rejected steps before giving up
+        f64 safety = 0.9f;
+        f64 min_factor = 0.2f;
+        f64 max_factor = 5.0f;
+    };
+
+    /**
+     * Returns the error of one component scaled by the mixed tolerance
+     * atol + rtol * max(|y0|, |y1|). A step is accepted when every scaled
+     * error is at most 1.
+     */
+    static inline f64 scaledError(f64 err, f64 y0, f64 y1, f64 rtol, f64 atol)  {
+        return std::fabs(err) / (atol + rtol * std::max(std::fabs(y0), std::fabs(y1)));
+    }
+
+    /**
+     * Integrates x in place from t0 to t1 with the Dormand-Prince 5(4) pair,
+     * adapting the step so that errorRatio(err, y0, y1) <= 1 on every step.
+     * f(x, t, out) writes dx/dt into out.
+     * errorRatio(err, y0, y1) returns the largest scaled error estimate.
+     * onStep(dense) is called after every accepted step.
+     * Post: returns stats with completed == false if max_steps was hit, in
+     * which case x holds the state at the last accepted time.
+     */
+    template <typename T, typename F, typename ErrorRatio, typename OnStep>
+        requires std::invocable<F&, const T&, f64, T&>
+    static inline DP45Stats dp45Integrate(
+        T& x,
+        f64 t0,
+        f64 t1,
+        F&& f,
+        ErrorRatio&& errorRatio,
+        const DP45Options& options,
+        DP45Workspace<T>& ws,
+        OnStep&& onStep
     )  {
-        T k1 = f(x0, t);
-        T k2 = f(x0 + k1 * (dt / 2.0), t + dt / 2.0);
-        T k3 = f(x0 + k2 * (dt / 2.0), t + dt / 2.0);
-        T k4 = f(x0 + k3 * dt, t + dt);
+        constexpr f64 c2 = 1.0 / 5.0, c3 = 3.0 / 10.0, c4 = 4.0 / 5.0, c5 = 8.0 / 9.0;
+        constexpr f64 a21 = 1.0 / 5.0;
+        constexpr f64 a31 = 3.0 / 40.0,       a32 = 9.0 / 40.0;
+        constexpr f64 a41 = 44.0 / 45.0,      a42 = -56.0 / 15.0,      a43 = 32.0 / 9.0;
+        constexpr f64 a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0, a53 = 64448.0 / 6561.0,
+                      a54 = -212.0 / 729.0;
+        constexpr f64 a61 = 9017.0 / 3168.0,  a62 = -355.0 / 33.0,     a63 = 46732.0 / 5247.0,
+                      a64 = 49.0 / 176.0,     a65 = -5103.0 / 18656.0;
+        constexpr f64 a71 = 35.0 / 384.0,     a73 = 500.0 / 1113.0,    a74 = 125.0 / 192.0,
+                      a75 = -2187.0 / 6784.0, a76 = 11.0 / 84.0;
+        constexpr f64 e1 = 71.0 / 57600.0,    e3 = -71.0 / 16695.0,    e4 = 71.0 / 1920.0,
+                      e5 = -17253.0 / 339200.0, e6 = 22.0 / 525.0,     e7 = -1.0 / 40.0;
+        constexpr f64 d1 = -12715105075.0 / 11282082432.0, d3 = 87487479700.0 / 32700410799.0,
+                      d4 = -10690763975.0 / 1880347072.0,  d5 = 701980252875.0 / 199316789632.0,
+                      d6 = -1453857185.0 / 822651844.0,    d7 = 69997945.0 / 29380423.0;
+
+        DP45Stats stats;
+        f64 t = t0;
+        f64 h = std::min(options.h0, t1 - t0);
+        if (h <= 0.0f) {
+            stats.completed = true;
+            return stats;
+        }
+
+        f(x, t, ws.k1);
+        while (stats.accepted + stats.rejected < options.max_steps) {
+            bool last = (t + h >= t1);
+            if (last) {
+                h = t1 - t;
+            }
 
-        return x0 + (k1 + k2 * 2.0 + k3 * 2.0 + k4) * (dt / 6.0);
+            ws.tmp = x + ws.k1 * (a21 * h);
+            f(ws.tmp, t + c2 * h, ws.k2);
+            ws.tmp = x + (ws.k1 * a31 + ws.k2 * a32) * h;
+            f(ws.tmp, t + c3 * h, ws.k3);
+            ws.tmp = x + (ws.k1 * a41 + ws.k2 * a42 + ws.k3 * a43) * h;
+            f(ws.tmp, t + c4 * h, ws.k4);
+            ws.tmp = x + (ws.k1 * a51 + ws.k2 * a52 + ws.k3 * a53 + ws.k4 * a54) * h;
+            f(ws.tmp, t + c5 * h, ws.k5);
+            ws.tmp = x + (ws.k1 * a61 + ws.k2 * a62 + ws.k3 * a63 + ws.k4 * a64 + ws.k5 * a65) * h;
+            f(ws.tmp, t + h, ws.k6);
+            ws.y_new = x + (ws.k1 * a71 + ws.k3 * a73 + ws.k4 * a74 + ws.k5 * a75 + ws.k6 * a76) * h;
+            f(ws.y_new, t + h, ws.k7);
+
+            ws.err = (ws.k1 * e1 + ws.k3 * e3 + ws.k4 * e4 + ws.k5 * e5 + ws.k6 * e6 + ws.k7 * e7) * h;
+            f64 ratio = errorRatio(ws.err, x, ws.y_new);
+
+            f64 factor = (ratio == 0.0f) 
+                ? options.max_factor 
+                : options.safety * std::pow(ratio, -0.2);
+            factor = MathConfig::clamp(factor, options.min_factor, options.max_factor);
+
+            if (ratio > 1.0f || !std::isfinite(ratio)) {
+                ++stats.rejected;
+                h *= std::isfinite(ratio) ? factor : options.min_factor;
+                continue;
+            }
+
+            DP45Dense<T> dense{
+                t, h,
+                x,
+                ws.y_new - x,
+                ws.k1 * h - (ws.y_new - x),
+                (ws.y_new - x) - ws.k7 * h - (ws.k1 * h - (ws.y_new - x)),
+                (ws.k1 * d1 + ws.k3 * d3 + ws.k4 * d4 + ws.k5 * d5 + ws.k6 * d6 + ws.k7 * d7) * h
+            };
+
+            ++stats.accepted;
+            stats.last_h = h;
+            t = last ? t1 : t + h;
+            x = ws.y_new;
+            ws.k1 = ws.k7;          // first same as last
+            onStep(dense);
+
+            if (last) {
+                stats.completed = true;
+                return stats;
+            }
+            h *= factor;
+        }
+
+        return stats;
+    }
+
+    template <typename T, typename F, typename ErrorRatio>
+        requires std::invocable<F&, const T&, f64, T&>
+    static inline DP45Stats dp45Integrate(
+        T& x,
+        f64 t0,
+        f64 t1,
+        F&& f,
+        ErrorRatio&& errorRatio,
+        const DP45Options& options,
+        DP45Workspace<T>& ws
+    )  {
+        return dp45Integrate(x, t0, t1, f, errorRatio, options, ws, [] (const DP45Dense<T>&) {});
+    }
+
+    // Symplectic integration of x'' = a(x, t)
+
+    /**
+     * Advances (x, v) by one velocity Verlet (kick-drift-kick) step of size h.
+     * acc holds accel(x, t) on entry and accel(x, t + h) on exit, so
+     * consecutive steps cost one acceleration evaluation each.
+     */
+    template <typename X, typename Accel>
+        requires std::invocable<Accel&, const X&, f64>
+    static inline void velocityVerletStep(
+        X& x, X& v, X& acc,
+        f64 t,
+        f64 h,
+        Accel&& accel
+    )  {
+        v = v + acc * (h / 2.0);
+        x = x + v * h;
+        acc = accel(x, t + h);
+        v = v + acc * (h / 2.0);
+    }
+
+    /**
+     * Advances (x, v) by one step of size h of Yoshida's 4th-order
+     * symplectic composition (drift-kick form, 3 acceleration evaluations).
+     * Time-dependent fields are evaluated at the time reached by each drift.
+     */
+    template <typename X, typename Accel>
+        requires std::invocable<Accel&, const X&, f64>
+    static inline void yoshida4Step(
+        X& x, X& v,
+        f64 t,
+        f64 h,
+        Accel&& accel
+    )  {
+        constexpr f64 cbrt2 = 1.2599210498948731648;   // 2^(1/3)
+        constexpr f64 w1 = 1.0 / (2.0 - cbrt2);
+        constexpr f64 w0 = -cbrt2 / (2.0 - cbrt2);
+        constexpr f64 c[4] = {w1 / 2.0, (w0 + w1) / 2.0, (w0 + w1) / 2.0, w1 / 2.0};
+        constexpr f64 d[3] = {w1, w0, w1};
+
+        for (size_t i = 0; i < 3; ++i) {
+            x = x + v * (c[i] * h);
+            t += c[i] * h;
+            v = v + accel(x, t) * (d[i] * h);
+        }
+        x = x + v * (c[3] * h);
+    }
+
+    // Analytic two-body propagation
+
+    /**
+     * Stumpff functions C(z) = sum (-z)^k / (2k + 2)! and
+     * S(z) = sum (-z)^k / (2k + 3)!, summed as series near z = 0 where the
+     * closed forms cancel.
+     */
+    static inline void stumpff(f64 z, f64& C, f64& S)  {
+        if (std::abs(z) < 0.1) {
+            f64 term_c = 0.5, term_s = 1.0 / 6.0;
+            C = 0.0f;
+            S = 0.0f;
+            for (i32 k = 0; k < 8; ++k) {
+                C += term_c;
+                S += term_s;
+                term_c *= -z / ((2 * k + 3) * (2 * k + 4));
+                term_s *= -z / ((2 * k + 4) * (2 * k + 5));
+            }
+        } else if (z > 0.0f) {
+            f64 x = std::sqrt(z);
+            f64 h = std::sin(0.5 * x);
+            C = 2.0 * h * h / z;
+            S = (x - std::sin(x)) / (z * x);
+        } else {
+            f64 x = std::sqrt(-z);
+            C = (std::cosh(x) - 1.0) / -z;
+            S = (std::sinh(x) - x) / (-z * x);
+        }
+    }
+
+    /**
+     * Advances the state (r, v) relative to a point mass of gravitational
+     * parameter mu by dt, solving the universal-variable Kepler equation with
+     * Newton's method (Curtis, "Orbital Mechanics for Engineering Students",
+     * 3.7). Covers elliptic, parabolic and hyperbolic arcs alike.
+     * chi is the initial guess for the universal anomaly, or 0 for the
+     * default one; it holds the solution on return, so chi * dt_next / dt
+     * warm-starts the next step along the same arc.
+     * Returns false, leaving r, v and chi unchanged, if Newton does not converge.
+     * Pre: mu > 0 and r != 0.
+     */
+    static inline bool keplerStep(Vec2& r, Vec2& v, f64 mu, f64 dt, f64& chi)  {
+        constexpr u32 max_iters = 50;
+        constexpr f64 tol = 1e-13;
+
+        f64 r0 = std::sqrt(norm2Sq(r));
+        f64 sqrt_mu = std::sqrt(mu);
+        f64 vr0 = dot(r, v) / r0;
+        f64 alpha = 2.0 / r0 - dot(v, v) / mu;
+
+        // The warm start first, if any, then the default guess.
+        f64 guesses[2] = {chi, sqrt_mu * std::abs(alpha) * dt};
+        for (u32 attempt = (chi == 0.0f) ? 1 : 0; attempt < 2; ++attempt) {
+            f64 x = guesses[attempt];
+            f64 C = 0.0f, S = 0.0f, z = 0.0f;
+            bool converged = false;
+            for (u32 it = 0; it < max_iters && !converged; ++it) {
+                z = alpha * x * x;
+                stumpff(z, C, S);
+                f64 F = r0 * vr0 / sqrt_mu * x * x * C + (1.0 - alpha * r0) * x * x * x * S
+                      + r0 * x - sqrt_mu * dt;
+                f64 dF = r0 * vr0 / sqrt_mu * x * (1.0 - z * S) + (1.0 - alpha * r0) * x * x * C + r0;
+                f64 step = F / dF;
+                x -= step;
+                converged = std::abs(step) <= tol * std::max(1.0, std::abs(x));
+            }
+            if (!converged || !std::isfinite(x)) {
+                continue;
+            }
+
+            z = alpha * x * x;
+            stumpff(z, C, S);
+            f64 f = 1.0 - x * x / r0 * C;
+            f64 g = dt - x * x * x / sqrt_mu * S;
+            Vec2 r1 = r * f + v * g;
+            f64 r1n = std::sqrt(norm2Sq(r1));
+            f64 fdot = sqrt_mu / (r1n * r0) * (z * S - 1.0) * x;
+            f64 gdot = 1.0 - x * x / r1n * C;
+
+            v = r * fdot + v * gdot;
+            r = r1;
+            chi = x;
+            return true;
+        }
+        return false;
     }
 
     // operations related to general matrices.
@@ -120,6 +596,10 @@ struct MathConfig {
         return result;
     }
 
+    static inline Vec2 round(const Vec2& v)  {
+        return {std::round(v.x), std::round(v.y)};
+    }
+
     // more to be added later.
 
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "matrix.h"
+#include "simd.h"
 
 Matrix::Matrix(size_t rows, size_t cols, f64 fill)
     : m(rows), n(cols), data_(rows * cols, fill) {}
@@ -9,25 +10,13 @@ Matrix::Matrix(size_t rows, size_t cols, const std::initializer_list<f64>& value
 }
 
 Matrix::Matrix(size_t rows, size_t cols, const std::vector<f64>& values) 
-    : m(rows), n(cols), data_(values) {
+    : m(rows), n(cols), data_(values.begin(), values.end()) {
     req(values.size() == rows * cols, "Vector size does not match matrix dimensions");
 }
 
-f64& Matrix::operator()(size_t i, size_t j) {
-    return data_[i * n + j];
-}
-
-const f64& Matrix::operator()(size_t i, size_t j) const {
-    return data_[i * n + j];
-}
-
 Matrix Matrix::T() const {
     Matrix result(n, m, 0.0f);
-    for (size_t i = 0; i < m; ++i) {
-        for (size_t j = 0; j < n; ++j) {
-            result(j, i) = (*this)(i, j);
-        }
-    }
+    simd::kernels().transpose(data(), result.data(), m, n);
     return result;
 }
 
@@ -56,21 +45,16 @@ f64 Matrix::trace() const {
 
 Matrix Matrix::scale(const Matrix& mat, f64 scalar) {
     Matrix result(mat.rows(), mat.cols(), 0.0f);
-    for (size_t i = 0; i < mat.rows(); ++i) {
-        for (size_t j = 0; j < mat.cols(); ++j) {
-            result(i, j) = mat(i, j) * scalar;
-        }
-    }
+    simd::kernels().scale(mat.data(), scalar, result.data(), mat.data_.size());
     return result;
 }
 
 Matrix Matrix::add(const Matrix& a, const Matrix& b) {
-    Matrix result(a.rows(), a.cols(), 0.0f);
-    for (size_t i = 0; i < a.rows(); ++i) {
-        for (size_t j = 0; j < a.cols(); ++j) {
-            result(i, j) = a(i, j) + b(i, j);
-        }
+    if (a.shape() != b.shape()) {
+        throw std::invalid_argument("Matrix dimensions do not match for addition");
     }
+    Matrix result(a.rows(), a.cols(), 0.0f);
+    simd::kernels().add(a.data(), b.data(), result.data(), a.data_.size());
     return result;
 }
 
@@ -79,32 +63,10 @@ Matrix Matrix::mul(const Matrix& a, const Matrix& b) {
         throw std::invalid_argument("Matrix dimensions do not match for multiplication");
     }
     Matrix result(a.rows(), b.cols(), 0.0f);
-    for (size_t i = 0; i < a.rows(); ++i) {
-        for (size_t j = 0; j < b.cols(); ++j) {
-            for (size_t k = 0; k < a.cols(); ++k) {
-                result(i, j) += a(i, k) * b(k, j);
-            }
-        }
-    }
+    simd::kernels().mul(a.data(), b.data(), result.data(), a.rows(), a.cols(), b.cols());
     return result;
 }
 
-Matrix operator*(const Matrix& mat, f64 scalar) {
-    return Matrix::scale(mat, scalar);
-}
-
-Matrix operator*(f64 scalar, const Matrix& mat) {
-    return Matrix::scale(mat, scalar);
-}
-
-Matrix operator+(const Matrix& a, const Matrix& b) {
-    return Matrix::add(a, b);
-}
-
-Matrix operator-(const Matrix& a, const Matrix& b) {
-    return Matrix::add(a, Matrix::scale(b, -1.0f));
-}
-
 Matrix operator*(const Matrix& a, const Matrix& b) {
     return Matrix::mul(a, b);
 }
@@ -138,7 +100,7 @@ Matrix Matrix::fromHomogeneous(const Matrix& mat) {
     return result;
 }
 
-Matrix eye(size_t size) {
+Matrix Matrix::eye(size_t size) {
     Matrix result(size, size, 0.0f);
     for (size_t i = 0; i < size; ++i) {
         result(i, i) = 1.0f;
@@ -146,7 +108,7 @@ Matrix eye(size_t size) {
     return result;
 }
 
-Matrix zero(size_t rows, size_t cols) {
+Matrix Matrix::zero(size_t rows, size_t cols) {
     return Matrix(rows, cols, 0.0f);
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <cstdint>
 #include <stdexcept>
 #include <functional>
@@ -8,10 +9,143 @@
 #include <utility>
 #include <compare>
 #include <initializer_list>
-#include <vector>
+#include <type_traits>
+#include <concepts>
+#include <cstddef>
 
 #include "utils/types.h"
 #include "utils/helpers.h"
+#include "utils/small_buffer.h"
+
+class Matrix;
+
+/**
+ * Trait marking types that can take part in lazy element-wise matrix expressions.
+ * A matrix expression exposes rows(), cols() and coeff(k), the k-th element in
+ * row-major order, and aliases(p, size): true iff it reads the row-major
+ * buffer [p, p + size) other than as coeff(k) == p[k], so evaluating it into
+ * that buffer in place could read an element after overwriting it.
+ */
+template <typename E>
+struct is_matrix_expr : std::false_type {};
+
+template <>
+struct is_matrix_expr<Matrix> : std::true_type {};
+
+template <typename E>
+concept MatrixExpression = is_matrix_expr<std::remove_cvref_t<E>>::value;
+
+/**
+ * A non-owning, strided view over f64 elements laid out in memory.
+ * Elem is f64 for a mutable view and const f64 for a read-only one.
+ * Abstraction function:
+ * BasicMatrixView(p, m, n, rs, cs) represents the m x n matrix whose element
+ * (i, j) is p[i * rs + j * cs], for 0 <= i < m and 0 <= j < n.
+ * Transposes, rows, columns and sub-blocks are views over the same memory,
+ * so none of them copy. A view must not outlive the memory it refers to.
+ */
+template <typename Elem>
+class BasicMatrixView {
+public:
+    BasicMatrixView() = default;
+
+    BasicMatrixView(
+        Elem* data, size_t rows, size_t cols,
+        std::ptrdiff_t row_stride, std::ptrdiff_t col_stride = 1
+    ) : data_(data), m(rows), n(cols), rs(row_stride), cs(col_stride) {}
+
+    /**
+     * Views a contiguous row-major buffer of rows * cols elements.
+     */
+    BasicMatrixView(Elem* data, size_t rows, size_t cols) 
+        : BasicMatrixView(data, rows, cols, static_cast<std::ptrdiff_t>(cols), 1) {}
+
+    /**
+     * A mutable view converts to a read-only one.
+     */
+    template <typename Other>
+        requires (std::is_convertible_v<Other*, Elem*> && !std::is_same_v<Other, Elem>)
+    BasicMatrixView(const BasicMatrixView<Other>& other)
+        : BasicMatrixView(other.data(), other.rows(), other.cols(), other.rowStride(), other.colStride()) {}
+
+    inline Elem& operator()(size_t i, size_t j) const { 
+        return data_[static_cast<std::ptrdiff_t>(i) * rs + static_cast<std::ptrdiff_t>(j) * cs]; 
+    }
+
+    inline size_t rows() const { return m; }
+    inline size_t cols() const { return n; }
+    inline size_t size() const { return m * n; }
+
+    inline std::pair<size_t, size_t> shape() const {
+        return {m, n};
+    }
+
+    inline Elem* data() const { return data_; }
+    inline std::ptrdiff_t rowStride() const { return rs; }
+    inline std::ptrdiff_t colStride() const { return cs; }
+
+    /**
+     * Returns the k-th element in row-major order of the view. Pre: 0 <= k < m * n.
+     */
+    inline f64 coeff(size_t k) const {
+        return n == 1 ? (*this)(k, 0) : (*this)(k / n, k % n);
+    }
+
+    /**
+     * True iff the view overlaps [p, p + size) and is not exactly the
+     * row-major m x n layout of that buffer (e.g. a transpose or a block).
+     */
+    inline bool aliases(const f64* p, size_t size) const {
+        if (m == 0 || n == 0 || size == 0) {
+            return false;
+        }
+        if (data_ == p && rs == static_cast<std::ptrdiff_t>(n) && cs == 1 && m * n == size) {
+            return false;
+        }
+        // Address range spanned by the view; strides may be negative.
+        auto last_i = static_cast<std::ptrdiff_t>(m - 1) * rs;
+        auto last_j = static_cast<std::ptrdiff_t>(n - 1) * cs;
+        const f64* lo = data_ + std::min<std::ptrdiff_t>(last_i, 0) + std::min<std::ptrdiff_t>(last_j, 0);
+        const f64* hi = data_ + std::max<std::ptrdiff_t>(last_i, 0) + std::max<std::ptrdiff_t>(last_j, 0);
+        return std::less_equal<const f64*>{}(lo, p + size - 1) && std::less_equal<const f64*>{}(p, hi);
+    }
+
+    /**
+     * Returns the transpose as a view over the same memory.
+     */
+    inline BasicMatrixView T() const {
+        return BasicMatrixView(data_, n, m, cs, rs);
+    }
+
+    /**
+     * Returns the r x c sub-block whose top-left element is (i, j).
+     * Pre: i + r <= rows(), j + c <= cols().
+     */
+    inline BasicMatrixView block(size_t i, size_t j, size_t r, size_t c) const {
+        return BasicMatrixView(&(*this)(i, j), r, c, rs, cs);
+    }
+
+    /**
+     * Returns row i as a 1 x n view. Pre: i < rows().
+     */
+    inline BasicMatrixView row(size_t i) const { return block(i, 0, 1, n); }
+
+    /**
+     * Returns column j as an m x 1 view. Pre: j < cols().
+     */
+    inline BasicMatrixView col(size_t j) const { return block(0, j, m, 1); }
+
+private:
+    Elem* data_ = nullptr;
+    size_t m = 0, n = 0;
+    std::ptrdiff_t rs = 0, cs = 0;
+};
+
+using MatrixView = BasicMatrixView<f64>;
+using ConstMatrixView = BasicMatrixView<const f64>;
+
+template <typename Elem>
+struct is_matrix_expr<BasicMatrixView<Elem>> : std::true_type {};
 
 /**
  * A simple matrix class for basic linear algebra operations. 
@@ -28,18 +162,90 @@ public:
     Matrix(size_t rows, size_t cols, const std::initializer_list<f64>& values);
     Matrix(size_t rows, size_t cols, const std::vector<f64>& values);
 
-    virtual f64& operator()(size_t i, size_t j);
-    virtual const f64& operator()(size_t i, size_t j) const;
+    /**
+     * Materializes a lazy matrix expression in a single pass.
+     */
+    template <MatrixExpression E>
+        requires (!std::is_same_v<std::remove_cvref_t<E>, Matrix>)
+    Matrix(const E& expr) 
+        : data_(expr.rows() * expr.cols()), m(expr.rows()), n(expr.cols()) {
+        for (size_t k = 0; k < data_.size(); ++k) {
+            data_[k] = expr.coeff(k);
+        }
+    }
+
+    /**
+     * Evaluates a lazy matrix expression into this matrix, reusing its buffer.
+     * The expression may read this matrix: when it does other than element
+     * for element (see is_matrix_expr), e.g. through a transpose view, it is
+     * evaluated into a temporary first.
+     */
+    template <MatrixExpression E>
+        requires (!std::is_same_v<std::remove_cvref_t<E>, Matrix>)
+    Matrix& operator=(const E& expr) {
+        if (expr.aliases(data(), data_.size())) {
+            return *this = Matrix(expr);
+        }
+        size_t rows = expr.rows(), cols = expr.cols();
+        if (rows != m || cols != n) {
+            data_.resize(rows * cols);
+            m = rows;
+            n = cols;
+        }
+        for (size_t k = 0; k < data_.size(); ++k) {
+            data_[k] = expr.coeff(k);
+        }
+        return *this;
+    }
+
+    inline f64& operator()(size_t i, size_t j) { return data_[i * n + j]; }
+    inline const f64& operator()(size_t i, size_t j) const { return data_[i * n + j]; }
 
-    virtual inline size_t rows() const { return m; }
-    virtual inline size_t cols() const { return n; }
+    inline size_t rows() const { return m; }
+    inline size_t cols() const { return n; }
 
     inline std::pair<size_t, size_t> shape() const {
         return {m, n};
     }
 
     /**
-     * Returns the transpose of the matrix.
+     * Returns the k-th element in row-major order. Pre: 0 <= k < m * n.
+     */
+    inline f64 coeff(size_t k) const { return data_[k]; }
+
+    /**
+     * A matrix reads its own buffer element for element, and no other
+     * matrix's buffer, so it never aliases.
+     */
+    inline bool aliases(const f64*, size_t) const { return false; }
+
+    /**
+     * Returns the underlying row-major buffer of m * n elements.
+     */
+    inline f64* data() { return data_.data(); }
+    inline const f64* data() const { return data_.data(); }
+
+    /**
+     * Returns a non-owning view over the whole matrix.
+     * The view is invalidated when the matrix is reshaped or destroyed.
+     */
+    inline MatrixView view() { return MatrixView(data(), m, n); }
+    inline ConstMatrixView view() const { return ConstMatrixView(data(), m, n); }
+
+    inline operator ConstMatrixView() const { return view(); }
+
+    inline MatrixView row(size_t i) { return view().row(i); }
+    inline ConstMatrixView row(size_t i) const { return view().row(i); }
+
+    inline MatrixView col(size_t j) { return view().col(j); }
+    inline ConstMatrixView col(size_t j) const { return view().col(j); }
+
+    inline MatrixView block(size_t i, size_t j, size_t r, size_t c) { return view().block(i, j, r, c); }
+    inline ConstMatrixView block(size_t i, size_t j, size_t r, size_t c) const { return view().block(i, j, r, c); }
+
+    /**
+     * Returns the transpose of the matrix as a new matrix.
+     * Use view().T() to read the transpose without copying.
      */
     Matrix T() const;
     /**
@@ -70,10 +276,6 @@ public:
     static Matrix add(const Matrix& a, const Matrix& b);
     static Matrix mul(const Matrix& a, const Matrix& b);
 
-    friend Matrix operator*(const Matrix& mat, f64 scalar);
-    friend Matrix operator*(f64 scalar, const Matrix& mat);
-    friend Matrix operator+(const Matrix& a, const Matrix& b);
-    friend Matrix operator-(const Matrix& a, const Matrix& b);
     friend Matrix operator*(const Matrix& a, const Matrix& b);
     
     static Matrix eye(size_t size);
@@ -100,15 +302,104 @@ public:
 private:
     /**
      * Representation invariant:
-     * - data_ is a flat vector storing matrix elements in row-major order.
+     * - data_ is a flat buffer storing matrix elements in row-major order.
      * - data_.size() == m * n, m -> rows, n -> columns
+     * - matrices of up to INLINE_SIZE elements (e.g. 3x3) do not allocate.
      */
 
-    std::vector<f64> data_ = {};
+    static constexpr size_t INLINE_SIZE = 9;
+
+    SmallBuffer<f64, INLINE_SIZE> data_ = {};
     size_t m = 0, n = 0;
 };
 
 
+// ----------------------------------------------------
+// --------------- Expression Templates ---------------
+// ----------------------------------------------------
+
+/**
+ * Operands are held by reference when they are lvalues and by value when they
+ * are temporaries, so an expression never outlives the data it reads.
+ */
+template <typename E>
+using matrix_operand_t = std::conditional_t<
+    std::is_lvalue_reference_v<E>,
+    const std::remove_reference_t<E>&,
+    std::remove_cvref_t<E>
+>;
+
+/**
+ * Lazy element-wise binary expression (a op b).
+ * Pre: a and b have the same shape.
+ */
+template <typename Op, typename A, typename B>
+class MatrixBinaryExpr {
+public:
+    MatrixBinaryExpr(A&& a, B&& b) 
+        : a_(std::forward<A>(a)), b_(std::forward<B>(b)) {}
+
+    inline size_t rows() const { return a_.rows(); }
+    inline size_t cols() const { return a_.cols(); }
+    inline f64 coeff(size_t k) const { return Op{}(a_.coeff(k), b_.coeff(k)); }
+    inline bool aliases(const f64* p, size_t size) const {
+        return a_.aliases(p, size) || b_.aliases(p, size);
+    }
+
+    inline Matrix eval() const { return Matrix(*this); }
+
+private:
+    matrix_operand_t<A> a_;
+    matrix_operand_t<B> b_;
+};
+
+/**
+ * Lazy scalar multiple of a matrix expression.
+ */
+template <typename A>
+class MatrixScaledExpr {
+public:
+    MatrixScaledExpr(A&& a, f64 scalar) 
+        : a_(std::forward<A>(a)), scalar_(scalar) {}
+
+    inline size_t rows() const { return a_.rows(); }
+    inline size_t cols() const { return a_.cols(); }
+    inline f64 coeff(size_t k) const { return a_.coeff(k) * scalar_; }
+    inline bool aliases(const f64* p, size_t size) const { return a_.aliases(p, size); }
+
+    inline Matrix eval() const { return Matrix(*this); }
+
+private:
+    matrix_operand_t<A> a_;
+    f64 scalar_;
+};
+
+template <typename Op, typename A, typename B>
+struct is_matrix_expr<MatrixBinaryExpr<Op, A, B>> : std::true_type {};
+
+template <typename A>
+struct is_matrix_expr<MatrixScaledExpr<A>> : std::true_type {};
+
+template <MatrixExpression A, MatrixExpression B>
+inline auto operator+(A&& a, B&& b) {
+    return MatrixBinaryExpr<std::plus<f64>, A, B>(std::forward<A>(a), std::forward<B>(b));
+}
+
+template <MatrixExpression A, MatrixExpression B>
+inline auto operator-(A&& a, B&& b) {
+    return MatrixBinaryExpr<std::minus<f64>, A, B>(std::forward<A>(a), std::forward<B>(b));
+}
+
+template <MatrixExpression A>
+inline auto operator*(A&& a, f64 scalar) {
+    return MatrixScaledExpr<A>(std::forward<A>(a), scalar);
+}
+
+template <MatrixExpression A>
+inline auto operator*(f64 scalar, A&& a) {
+    return MatrixScaledExpr<A>(std::forward<A>(a), scalar);
+}
+
 template <>
 struct std::hash<Matrix> {
     inline size_t operator()(const Matrix& mat) const {
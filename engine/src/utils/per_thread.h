@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "utils/types.h"
+
+/**
+ * One T per (owner, thread), for memoization inside const methods that must
+ * stay safe to call concurrently: each thread only ever sees its own T.
+ * Owners are told apart by a process-unique key rather than their address,
+ * so a later owner at the same address never picks up stale state. A
+ * thread's T is created on its first local() call and freed when the owner
+ * is destroyed (on the destroying thread) or when the thread exits.
+ */
+template <typename T>
+class PerThread {
+public:
+    PerThread() : key_(next_key_.fetch_add(1, std::memory_order_relaxed)) {}
+
+    // Copies get state of their own.
+    PerThread(const PerThread&) : PerThread() {}
+    PerThread& operator=(const PerThread&) { return *this; }
+
+    ~PerThread() {
+        if (auto* reg = registry()) {
+            if (reg->last.first == key_) {
+                reg->last = {NONE, nullptr};
+            }
+            reg->slots.erase(key_);
+        }
+    }
+
+    /**
+     * Returns the calling thread's T for this owner.
+     * Pre: the calling thread has not started exiting.
+     */
+    inline T& local() const {
+        auto* reg = registry();
+        if (reg->last.first != key_) {
+            reg->last = {key_, &reg->slots[key_]};
+        }
+        return *reg->last.second;
+    }
+
+private:
+    static constexpr u64 NONE = static_cast<u64>(-1);
+
+    struct Registry {
+        // Node-based, so references stay valid while other owners are added.
+        umap<u64, T> slots;
+        // The most recent lookup, which skips the hash lookup.
+        std::pair<u64, T*> last = {NONE, nullptr};
+    };
+
+    /**
+     * Returns the calling thread's registry, or nullptr once it has been
+     * destroyed at thread exit (an owner may outlive it, e.g. a static one).
+     */
+    static inline Registry* registry() {
+        thread_local bool destroyed = false;
+        struct Guarded : Registry {
+            ~Guarded() { destroyed = true; }
+        };
+        thread_local Guarded registry;
+        return destroyed ? nullptr : &registry;
+    }
+
+    static inline std::atomic<u64> next_key_ = 0;
+    u64 key_;
+};
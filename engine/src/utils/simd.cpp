@@ -0,0 +1,675 @@
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#else
+    #define SIMD_X86 0
+#endif
+
+// MSVC accepts any intrinsic without per-function target flags.
+#if SIMD_X86 && !defined(_MSC_VER)
+    #define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define SIMD_TARGET(isa)
+#endif
+
+namespace simd {
+
+namespace {
+
+// Tile sizes for the blocked kernels, chosen so that one tile of each
+// operand of mul stays within L1/L2.
+constexpr size_t MUL_TILE_I = 64;
+constexpr size_t MUL_TILE_K = 128;
+constexpr size_t MUL_TILE_J = 256;
+constexpr size_t TRANSPOSE_TILE = 32;
+
+// Cody-Waite split of pi/2 and the fdlibm minimax polynomials for sin and
+// cos on [-pi/4, pi/4]. pio2_1 has 33 significant bits, so q * pio2_1 is exact
+// for |q| < 2^20.
+constexpr f64 TWO_OVER_PI = 6.36619772367581382433e-01;
+constexpr f64 PIO2_1 = 1.57079632673412561417e+00;
+constexpr f64 PIO2_2 = 6.07710050630396597660e-11;
+constexpr f64 PIO2_3 = 2.02226624871116645580e-21;
+constexpr f64 SIN_C[6] = {
+    -1.66666666666666324348e-01,  8.33333333332248946124e-03,
+    -1.98412698298579493134e-04,  2.75573137070700676789e-06,
+    -2.50507602534068634195e-08,  1.58969099521155010221e-10,
+};
+constexpr f64 COS_C[6] = {
+     4.16666666666666019037e-02, -1.38888888888741095749e-03,
+     2.48015872894767294178e-05, -2.75573143513906633035e-07,
+     2.08757232129817482790e-09, -1.13596475577881948265e-11,
+};
+
+// ------------------------------ Scalar ------------------------------
+
+void addScalar(const f64* a, const f64* b, f64* out, size_t size) {
+    for (size_t k = 0; k < size; ++k) {
+        out[k] = a[k] + b[k];
+    }
+}
+
+void scaleScalar(const f64* a, f64 scalar, f64* out, size_t size) {
+    for (size_t k = 0; k < size; ++k) {
+        out[k] = a[k] * scalar;
+    }
+}
+
+void mulScalar(const f64* a, const f64* b, f64* out, size_t m, size_t kd, size_t n) {
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            f64 acc = 0.0f;
+            for (size_t k = 0; k < kd; ++k) {
+                acc += a[i * kd + k] * b[k * n + j];
+            }
+            out[i * n + j] = acc;
+        }
+    }
+}
+
+/**
+ * Branch-free sincos on which the vector kernels are modelled, step for step.
+ */
+inline void sincosOne(f64 x, f64& s, f64& c) {
+    f64 q = std::nearbyint(x * TWO_OVER_PI);
+    f64 r = ((x - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+    f64 z = r * r;
+
+    f64 ps = SIN_C[5];
+    for (i32 i = 4; i >= 0; --i) { ps = ps * z + SIN_C[i]; }
+    f64 sr = r + (r * z) * ps;
+
+    f64 pc = COS_C[5];
+    for (i32 i = 4; i >= 0; --i) { pc = pc * z + COS_C[i]; }
+    f64 cr = (1.0 - 0.5 * z) + (z * z) * pc;
+
+    // Quadrant j = q mod 4 selects and negates the reduced results.
+    f64 j = q - 4.0 * std::floor(q * 0.25);
+    bool odd = (j - 2.0 * std::floor(j * 0.5)) == 1.0;
+    f64 s0 = odd ? cr : sr;
+    f64 c0 = odd ? sr : cr;
+    s = (j >= 2.0) ? -s0 : s0;
+    c = (j >= 1.0 && j <= 2.0) ? -c0 : c0;
+}
+
+void sincosScalar(const f64* x, f64* s, f64* c, size_t size) {
+    for (size_t k = 0; k < size; ++k) {
+        sincosOne(x[k], s[k], c[k]);
+    }
+}
+
+/**
+ * Field at one query point, on which the vector kernels are modelled.
+ */
+template <bool Phi>
+inline void gravityOne(
+    f64 qx, f64 qy, const f64* bx, const f64* by, const f64* gm, size_t nb,
+    f64 eps, f64& ax, f64& ay, f64* phi
+) {
+    f64 sx = 0.0, sy = 0.0, sp = 0.0;
+    for (size_t b = 0; b < nb; ++b) {
+        f64 rx = bx[b] - qx;
+        f64 ry = by[b] - qy;
+        f64 d2 = rx * rx + ry * ry;
+        f64 d = std::sqrt(d2);
+        f64 s = gm[b] * (1.0 / (d2 * d + eps));
+        sx = sx + rx * s;
+        sy = sy + ry * s;
+        if constexpr (Phi) {
+            sp = sp + gm[b] / (d + eps);
+        }
+    }
+    ax = sx;
+    ay = sy;
+    if constexpr (Phi) {
+        *phi = sp;
+    }
+}
+
+void gravityScalar(
+    const f64* qx, const f64* qy, size_t nq,
+    const f64* bx, const f64* by, const f64* gm, size_t nb,
+    f64 eps, f64* ax, f64* ay, f64* phi
+) {
+    for (size_t k = 0; k < nq; ++k) {
+        if (phi) {
+            gravityOne<true>(qx[k], qy[k], bx, by, gm, nb, eps, ax[k], ay[k], phi + k);
+        } else {
+            gravityOne<false>(qx[k], qy[k], bx, by, gm, nb, eps, ax[k], ay[k], nullptr);
+        }
+    }
+}
+
+void transposeScalar(const f64* a, f64* out, size_t m, size_t n) {
+    for (size_t i0 = 0; i0 < m; i0 += TRANSPOSE_TILE) {
+        for (size_t j0 = 0; j0 < n; j0 += TRANSPOSE_TILE) {
+            size_t i1 = std::min(i0 + TRANSPOSE_TILE, m);
+            size_t j1 = std::min(j0 + TRANSPOSE_TILE, n);
+            for (size_t i = i0; i < i1; ++i) {
+                for (size_t j = j0; j < j1; ++j) {
+                    out[j * m + i] = a[i * n + j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Blocked i-k-j multiplication. For every output element the products are
+ * still accumulated in ascending k, starting from zero, which keeps the result
+ * identical to mulScalar. RowUpdate(ci, bk, aik, j0, j1) performs
+ * ci[j] += aik * bk[j] for j in [j0, j1).
+ */
+template <typename RowUpdate>
+inline void mulBlocked(
+    const f64* a, const f64* b, f64* out,
+    size_t m, size_t kd, size_t n, RowUpdate&& update
+) {
+    std::fill(out, out + m * n, 0.0f);
+    for (size_t i0 = 0; i0 < m; i0 += MUL_TILE_I) {
+        size_t i1 = std::min(i0 + MUL_TILE_I, m);
+        for (size_t j0 = 0; j0 < n; j0 += MUL_TILE_J) {
+            size_t j1 = std::min(j0 + MUL_TILE_J, n);
+            for (size_t k0 = 0; k0 < kd; k0 += MUL_TILE_K) {
+                size_t k1 = std::min(k0 + MUL_TILE_K, kd);
+                for (size_t i = i0; i < i1; ++i) {
+                    f64* ci = out + i * n;
+                    for (size_t k = k0; k < k1; ++k) {
+                        update(ci, b + k * n, a[i * kd + k], j0, j1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#if SIMD_X86
+
+// ------------------------------- SSE2 -------------------------------
+
+SIMD_TARGET("sse2")
+void addSSE2(const f64* a, const f64* b, f64* out, size_t size) {
+    size_t k = 0;
+    for (; k + 2 <= size; k += 2) {
+        _mm_storeu_pd(out + k, _mm_add_pd(_mm_loadu_pd(a + k), _mm_loadu_pd(b + k)));
+    }
+    for (; k < size; ++k) {
+        out[k] = a[k] + b[k];
+    }
+}
+
+SIMD_TARGET("sse2")
+void scaleSSE2(const f64* a, f64 scalar, f64* out, size_t size) {
+    __m128d s = _mm_set1_pd(scalar);
+    size_t k = 0;
+    for (; k + 2 <= size; k += 2) {
+        _mm_storeu_pd(out + k, _mm_mul_pd(_mm_loadu_pd(a + k), s));
+    }
+    for (; k < size; ++k) {
+        out[k] = a[k] * scalar;
+    }
+}
+
+SIMD_TARGET("sse2")
+void mulSSE2(const f64* a, const f64* b, f64* out, size_t m, size_t kd, size_t n) {
+    mulBlocked(a, b, out, m, kd, n, [] (f64* ci, const f64* bk, f64 aik, size_t j0, size_t j1) {
+        __m128d av = _mm_set1_pd(aik);
+        size_t j = j0;
+        for (; j + 2 <= j1; j += 2) {
+            __m128d prod = _mm_mul_pd(av, _mm_loadu_pd(bk + j));
+            _mm_storeu_pd(ci + j, _mm_add_pd(_mm_loadu_pd(ci + j), prod));
+        }
+        for (; j < j1; ++j) {
+            ci[j] += aik * bk[j];
+        }
+    });
+}
+
+// ------------------------------- AVX2 -------------------------------
+
+SIMD_TARGET("avx2")
+void addAVX2(const f64* a, const f64* b, f64* out, size_t size) {
+    size_t k = 0;
+    for (; k + 4 <= size; k += 4) {
+        _mm256_storeu_pd(out + k, _mm256_add_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k)));
+    }
+    for (; k < size; ++k) {
+        out[k] = a[k] + b[k];
+    }
+}
+
+SIMD_TARGET("avx2")
+void scaleAVX2(const f64* a, f64 scalar, f64* out, size_t size) {
+    __m256d s = _mm256_set1_pd(scalar);
+    size_t k = 0;
+    for (; k + 4 <= size; k += 4) {
+        _mm256_storeu_pd(out + k, _mm256_mul_pd(_mm256_loadu_pd(a + k), s));
+    }
+    for (; k < size; ++k) {
+        out[k] = a[k] * scalar;
+    }
+}
+
+SIMD_TARGET("avx2")
+void mulAVX2(const f64* a, const f64* b, f64* out, size_t m, size_t kd, size_t n) {
+    // Lambdas do not inherit the target attribute, so the row update lives in the loop.
+    std::fill(out, out + m * n, 0.0f);
+    for (size_t i0 = 0; i0 < m; i0 += MUL_TILE_I) {
+        size_t i1 = std::min(i0 + MUL_TILE_I, m);
+        for (size_t j0 = 0; j0 < n; j0 += MUL_TILE_J) {
+            size_t j1 = std::min(j0 + MUL_TILE_J, n);
+            for (size_t k0 = 0; k0 < kd; k0 += MUL_TILE_K) {
+                size_t k1 = std::min(k0 + MUL_TILE_K, kd);
+                for (size_t i = i0; i < i1; ++i) {
+                    f64* ci = out + i * n;
+                    for (size_t k = k0; k < k1; ++k) {
+                        const f64* bk = b + k * n;
+                        f64 aik = a[i * kd + k];
+                        __m256d av = _mm256_set1_pd(aik);
+                        size_t j = j0;
+                        for (; j + 4 <= j1; j += 4) {
+                            __m256d prod = _mm256_mul_pd(av, _mm256_loadu_pd(bk + j));
+                            _mm256_storeu_pd(ci + j, _mm256_add_pd(_mm256_loadu_pd(ci + j), prod));
+                        }
+                        for (; j < j1; ++j) {
+                            ci[j] += aik * bk[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+SIMD_TARGET("avx2")
+void transposeAVX2(const f64* a, f64* out, size_t m, size_t n) {
+    for (size_t i0 = 0; i0 < m; i0 += TRANSPOSE_TILE) {
+        for (size_t j0 = 0; j0 < n; j0 += TRANSPOSE_TILE) {
+            size_t i1 = std::min(i0 + TRANSPOSE_TILE, m);
+            size_t j1 = std::min(j0 + TRANSPOSE_TILE, n);
+
+            size_t i = i0;
+            for (; i + 4 <= i1; i += 4) {
+                size_t j = j0;
+                for (; j + 4 <= j1; j += 4) {
+                    // 4x4 in-register transpose.
+                    __m256d r0 = _mm256_loadu_pd(a + (i + 0) * n + j);
+                    __m256d r1 = _mm256_loadu_pd(a + (i + 1) * n + j);
+                    __m256d r2 = _mm256_loadu_pd(a + (i + 2) * n + j);
+                    __m256d r3 = _mm256_loadu_pd(a + (i + 3) * n + j);
+
+                    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+                    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+                    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+                    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+                    _mm256_storeu_pd(out + (j + 0) * m + i, _mm256_permute2f128_pd(t0, t2, 0x20));
+                    _mm256_storeu_pd(out + (j + 1) * m + i, _mm256_permute2f128_pd(t1, t3, 0x20));
+                    _mm256_storeu_pd(out + (j + 2) * m + i, _mm256_permute2f128_pd(t0, t2, 0x31));
+                    _mm256_storeu_pd(out + (j + 3) * m + i, _mm256_permute2f128_pd(t1, t3, 0x31));
+                }
+                for (; j < j1; ++j) {
+                    for (size_t r = i; r < i + 4; ++r) {
+                        out[j * m + r] = a[r * n + j];
+                    }
+                }
+            }
+            for (; i < i1; ++i) {
+                for (size_t j = j0; j < j1; ++j) {
+                    out[j * m + i] = a[i * n + j];
+                }
+            }
+        }
+    }
+}
+
+SIMD_TARGET("avx2")
+void sincosAVX2(const f64* x, f64* s, f64* c, size_t size) {
+    const __m256d one = _mm256_set1_pd(1.0), two = _mm256_set1_pd(2.0), four = _mm256_set1_pd(4.0);
+    const __m256d half = _mm256_set1_pd(0.5), quarter = _mm256_set1_pd(0.25);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    size_t k = 0;
+    for (; k + 4 <= size; k += 4) {
+        __m256d xv = _mm256_loadu_pd(x + k);
+        __m256d q = _mm256_round_pd(
+            _mm256_mul_pd(xv, _mm256_set1_pd(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC
+        );
+        __m256d r = _mm256_sub_pd(xv, _mm256_mul_pd(q, _mm256_set1_pd(PIO2_1)));
+        r = _mm256_sub_pd(r, _mm256_mul_pd(q, _mm256_set1_pd(PIO2_2)));
+        r = _mm256_sub_pd(r, _mm256_mul_pd(q, _mm256_set1_pd(PIO2_3)));
+        __m256d z = _mm256_mul_pd(r, r);
+
+        __m256d ps = _mm256_set1_pd(SIN_C[5]);
+        __m256d pc = _mm256_set1_pd(COS_C[5]);
+        for (i32 i = 4; i >= 0; --i) {
+            ps = _mm256_add_pd(_mm256_mul_pd(ps, z), _mm256_set1_pd(SIN_C[i]));
+            pc = _mm256_add_pd(_mm256_mul_pd(pc, z), _mm256_set1_pd(COS_C[i]));
+        }
+        __m256d sr = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, z), ps));
+        __m256d cr = _mm256_add_pd(
+            _mm256_sub_pd(one, _mm256_mul_pd(half, z)), _mm256_mul_pd(_mm256_mul_pd(z, z), pc)
+        );
+
+        __m256d j = _mm256_sub_pd(q, _mm256_mul_pd(four, _mm256_floor_pd(_mm256_mul_pd(q, quarter))));
+        __m256d parity = _mm256_sub_pd(j, _mm256_mul_pd(two, _mm256_floor_pd(_mm256_mul_pd(j, half))));
+        __m256d odd = _mm256_cmp_pd(parity, one, _CMP_EQ_OQ);
+        __m256d s0 = _mm256_blendv_pd(sr, cr, odd);
+        __m256d c0 = _mm256_blendv_pd(cr, sr, odd);
+        __m256d s_neg = _mm256_cmp_pd(j, two, _CMP_GE_OQ);
+        __m256d c_neg = _mm256_and_pd(_mm256_cmp_pd(j, one, _CMP_GE_OQ), _mm256_cmp_pd(j, two, _CMP_LE_OQ));
+        __m256d cv = _mm256_xor_pd(c0, _mm256_and_pd(c_neg, sign));
+        _mm256_storeu_pd(s + k, _mm256_xor_pd(s0, _mm256_and_pd(s_neg, sign)));
+        _mm256_storeu_pd(c + k, cv);
+    }
+    for (; k < size; ++k) {
+        sincosOne(x[k], s[k], c[k]);
+    }
+}
+
+template <bool Phi>
+SIMD_TARGET("avx2")
+void gravityAVX2Impl(
+    const f64* qx, const f64* qy, size_t nq,
+    const f64* bx, const f64* by, const f64* gm, size_t nb,
+    f64 eps, f64* ax, f64* ay, f64* phi
+) {
+    const __m256d one = _mm256_set1_pd(1.0), epsv = _mm256_set1_pd(eps);
+    size_t k = 0;
+    for (; k + 4 <= nq; k += 4) {
+        __m256d qxv = _mm256_loadu_pd(qx + k), qyv = _mm256_loadu_pd(qy + k);
+        __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd(), sp = _mm256_setzero_pd();
+        for (size_t b = 0; b < nb; ++b) {
+            __m256d rx = _mm256_sub_pd(_mm256_set1_pd(bx[b]), qxv);
+            __m256d ry = _mm256_sub_pd(_mm256_set1_pd(by[b]), qyv);
+            __m256d d2 = _mm256_add_pd(_mm256_mul_pd(rx, rx), _mm256_mul_pd(ry, ry));
+            __m256d d = _mm256_sqrt_pd(d2);
+            __m256d g = _mm256_set1_pd(gm[b]);
+            __m256d s = _mm256_mul_pd(g, _mm256_div_pd(one, _mm256_add_pd(_mm256_mul_pd(d2, d), epsv)));
+            sx = _mm256_add_pd(sx, _mm256_mul_pd(rx, s));
+            sy = _mm256_add_pd(sy, _mm256_mul_pd(ry, s));
+            if constexpr (Phi) {
+                sp = _mm256_add_pd(sp, _mm256_div_pd(g, _mm256_add_pd(d, epsv)));
+            }
+        }
+        _mm256_storeu_pd(ax + k, sx);
+        _mm256_storeu_pd(ay + k, sy);
+        if constexpr (Phi) {
+            _mm256_storeu_pd(phi + k, sp);
+        }
+    }
+    for (; k < nq; ++k) {
+        gravityOne<Phi>(qx[k], qy[k], bx, by, gm, nb, eps, ax[k], ay[k], Phi ? phi + k : nullptr);
+    }
+}
+
+void gravityAVX2(
+    const f64* qx, const f64* qy, size_t nq,
+    const f64* bx, const f64* by, const f64* gm, size_t nb,
+    f64 eps, f64* ax, f64* ay, f64* phi
+) {
+    if (phi) {
+        gravityAVX2Impl<true>(qx, qy, nq, bx, by, gm, nb, eps, ax, ay, phi);
+    } else {
+        gravityAVX2Impl<false>(qx, qy, nq, bx, by, gm, nb, eps, ax, ay, phi);
+    }
+}
+
+// ------------------------------ AVX-512 -----------------------------
+
+SIMD_TARGET("avx512f")
+void addAVX512(const f64* a, const f64* b, f64* out, size_t size) {
+    size_t k = 0;
+    for (; k + 8 <= size; k += 8) {
+        _mm512_storeu_pd(out + k, _mm512_add_pd(_mm512_loadu_pd(a + k), _mm512_loadu_pd(b + k)));
+    }
+    for (; k < size; ++k) {
+        out[k] = a[k] + b[k];
+    }
+}
+
+SIMD_TARGET("avx512f")
+void scaleAVX512(const f64* a, f64 scalar, f64* out, size_t size) {
+    __m512d s = _mm512_set1_pd(scalar);
+    size_t k = 0;
+    for (; k + 8 <= size; k += 8) {
+        _mm512_storeu_pd(out + k, _mm512_mul_pd(_mm512_loadu_pd(a + k), s));
+    }
+    for (; k < size; ++k) {
+        out[k] = a[k] * scalar;
+    }
+}
+
+SIMD_TARGET("avx512f")
+void mulAVX512(const f64* a, const f64* b, f64* out, size_t m, size_t kd, size_t n) {
+    std::fill(out, out + m * n, 0.0f);
+    for (size_t i0 = 0; i0 < m; i0 += MUL_TILE_I) {
+        size_t i1 = std::min(i0 + MUL_TILE_I, m);
+        for (size_t j0 = 0; j0 < n; j0 += MUL_TILE_J) {
+            size_t j1 = std::min(j0 + MUL_TILE_J, n);
+            for (size_t k0 = 0; k0 < kd; k0 += MUL_TILE_K) {
+                size_t k1 = std::min(k0 + MUL_TILE_K, kd);
+                for (size_t i = i0; i < i1; ++i) {
+                    f64* ci = out + i * n;
+                    for (size_t k = k0; k < k1; ++k) {
+                        const f64* bk = b + k * n;
+                        f64 aik = a[i * kd + k];
+                        __m512d av = _mm512_set1_pd(aik);
+                        size_t j = j0;
+                        for (; j + 8 <= j1; j += 8) {
+                            __m512d prod = _mm512_mul_pd(av, _mm512_loadu_pd(bk + j));
+                            _mm512_storeu_pd(ci + j, _mm512_add_pd(_mm512_loadu_pd(ci + j), prod));
+                        }
+                        for (; j < j1; ++j) {
+                            ci[j] += aik * bk[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+SIMD_TARGET("avx512f")
+void sincosAVX512(const f64* x, f64* s, f64* c, size_t size) {
+    const __m512d one = _mm512_set1_pd(1.0), two = _mm512_set1_pd(2.0), four = _mm512_set1_pd(4.0);
+    const __m512d half = _mm512_set1_pd(0.5), quarter = _mm512_set1_pd(0.25);
+    const __m512i sign = _mm512_set1_epi64(static_cast<i64>(0x8000000000000000ULL));
+    size_t k = 0;
+    for (; k + 8 <= size; k += 8) {
+        __m512d xv = _mm512_loadu_pd(x + k);
+        __m512d q = _mm512_roundscale_pd(
+            _mm512_mul_pd(xv, _mm512_set1_pd(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC
+        );
+        __m512d r = _mm512_sub_pd(xv, _mm512_mul_pd(q, _mm512_set1_pd(PIO2_1)));
+        r = _mm512_sub_pd(r, _mm512_mul_pd(q, _mm512_set1_pd(PIO2_2)));
+        r = _mm512_sub_pd(r, _mm512_mul_pd(q, _mm512_set1_pd(PIO2_3)));
+        __m512d z = _mm512_mul_pd(r, r);
+
+        __m512d ps = _mm512_set1_pd(SIN_C[5]);
+        __m512d pc = _mm512_set1_pd(COS_C[5]);
+        for (i32 i = 4; i >= 0; --i) {
+            ps = _mm512_add_pd(_mm512_mul_pd(ps, z), _mm512_set1_pd(SIN_C[i]));
+            pc = _mm512_add_pd(_mm512_mul_pd(pc, z), _mm512_set1_pd(COS_C[i]));
+        }
+        __m512d sr = _mm512_add_pd(r, _mm512_mul_pd(_mm512_mul_pd(r, z), ps));
+        __m512d cr = _mm512_add_pd(
+            _mm512_sub_pd(one, _mm512_mul_pd(half, z)), _mm512_mul_pd(_mm512_mul_pd(z, z), pc)
+        );
+
+        __m512d fq = _mm512_roundscale_pd(_mm512_mul_pd(q, quarter), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        __m512d j = _mm512_sub_pd(q, _mm512_mul_pd(four, fq));
+        __m512d fj = _mm512_roundscale_pd(_mm512_mul_pd(j, half), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        __mmask8 odd = _mm512_cmp_pd_mask(_mm512_sub_pd(j, _mm512_mul_pd(two, fj)), one, _CMP_EQ_OQ);
+        __m512d s0 = _mm512_mask_blend_pd(odd, sr, cr);
+        __m512d c0 = _mm512_mask_blend_pd(odd, cr, sr);
+        __mmask8 s_neg = _mm512_cmp_pd_mask(j, two, _CMP_GE_OQ);
+        __mmask8 c_neg = _mm512_cmp_pd_mask(j, one, _CMP_GE_OQ) & _mm512_cmp_pd_mask(j, two, _CMP_LE_OQ);
+        __m512i sv = _mm512_mask_xor_epi64(_mm512_castpd_si512(s0), s_neg, _mm512_castpd_si512(s0), sign);
+        __m512i cv = _mm512_mask_xor_epi64(_mm512_castpd_si512(c0), c_neg, _mm512_castpd_si512(c0), sign);
+        _mm512_storeu_pd(s + k, _mm512_castsi512_pd(sv));
+        _mm512_storeu_pd(c + k, _mm512_castsi512_pd(cv));
+    }
+    for (; k < size; ++k) {
+        sincosOne(x[k], s[k], c[k]);
+    }
+}
+
+template <bool Phi>
+SIMD_TARGET("avx512f")
+void gravityAVX512Impl(
+    const f64* qx, const f64* qy, size_t nq,
+    const f64* bx, const f64* by, const f64* gm, size_t nb,
+    f64 eps, f64* ax, f64* ay, f64* phi
+) {
+    const __m512d one = _mm512_set1_pd(1.0), epsv = _mm512_set1_pd(eps);
+    size_t k = 0;
+    for (; k + 8 <= nq; k += 8) {
+        __m512d qxv = _mm512_loadu_pd(qx + k), qyv = _mm512_loadu_pd(qy + k);
+        __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd(), sp = _mm512_setzero_pd();
+        for (size_t b = 0; b < nb; ++b) {
+            __m512d rx = _mm512_sub_pd(_mm512_set1_pd(bx[b]), qxv);
+            __m512d ry = _mm512_sub_pd(_mm512_set1_pd(by[b]), qyv);
+            __m512d d2 = _mm512_add_pd(_mm512_mul_pd(rx, rx), _mm512_mul_pd(ry, ry));
+            __m512d d = _mm512_sqrt_pd(d2);
+            __m512d g = _mm512_set1_pd(gm[b]);
+            __m512d s = _mm512_mul_pd(g, _mm512_div_pd(one, _mm512_add_pd(_mm512_mul_pd(d2, d), epsv)));
+            sx = _mm512_add_pd(sx, _mm512_mul_pd(rx, s));
+            sy = _mm512_add_pd(sy, _mm512_mul_pd(ry, s));
+            if constexpr (Phi) {
+                sp = _mm512_add_pd(sp, _mm512_div_pd(g, _mm512_add_pd(d, epsv)));
+            }
+        }
+        _mm512_storeu_pd(ax + k, sx);
+        _mm512_storeu_pd(ay + k, sy);
+        if constexpr (Phi) {
+            _mm512_storeu_pd(phi + k, sp);
+        }
+    }
+    for (; k < nq; ++k) {
+        gravityOne<Phi>(qx[k], qy[k], bx, by, gm, nb, eps, ax[k], ay[k], Phi ? phi + k : nullptr);
+    }
+}
+
+void gravityAVX512(
+    const f64* qx, const f64* qy, size_t nq,
+    const f64* bx, const f64* by, const f64* gm, size_t nb,
+    f64 eps, f64* ax, f64* ay, f64* phi
+) {
+    if (phi) {
+        gravityAVX512Impl<true>(qx, qy, nq, bx, by, gm, nb, eps, ax, ay, phi);
+    } else {
+        gravityAVX512Impl<false>(qx, qy, nq, bx, by, gm, nb, eps, ax, ay, phi);
+    }
+}
+
+bool osSupportsAvx(u64 mask) {
+#if defined(_MSC_VER)
+    return (_xgetbv(0) & mask) == mask;
+#else
+    u32 lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((static_cast<u64>(hi) << 32 | lo) & mask) == mask;
+#endif
+}
+
+void cpuid(i32 regs[4], i32 leaf, i32 subleaf) {
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    __asm__ volatile("cpuid"
+        : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+        : "a"(leaf), "c"(subleaf));
+#endif
+}
+
+#endif // SIMD_X86
+
+const Kernels SCALAR_KERNELS {
+    Isa::Scalar, addScalar, scaleScalar, mulScalar, transposeScalar, sincosScalar, gravityScalar
+};
+
+#if SIMD_X86
+// SSE2 has no packed rounding, so its sincos stays scalar; two lanes do not
+// pay for the gravity kernel's broadcasts either.
+const Kernels SSE2_KERNELS {
+    Isa::SSE2, addSSE2, scaleSSE2, mulSSE2, transposeScalar, sincosScalar, gravityScalar
+};
+const Kernels AVX2_KERNELS {
+    Isa::AVX2, addAVX2, scaleAVX2, mulAVX2, transposeAVX2, sincosAVX2, gravityAVX2
+};
+const Kernels AVX512_KERNELS {
+    Isa::AVX512, addAVX512, scaleAVX512, mulAVX512, transposeAVX2, sincosAVX512, gravityAVX512
+};
+#endif
+
+}
+
+Isa detect() {
+#if SIMD_X86
+    i32 regs[4] = {};
+    cpuid(regs, 0, 0);
+    i32 max_leaf = regs[0];
+
+    cpuid(regs, 1, 0);
+    bool osxsave = (regs[2] >> 27) & 1;
+    bool avx     = (regs[2] >> 28) & 1;
+
+    Isa best = Isa::SSE2; // baseline of every x86-64 CPU
+    if (!osxsave || !avx || max_leaf < 7 || !osSupportsAvx(0x6)) {
+        return best;
+    }
+
+    cpuid(regs, 7, 0);
+    bool avx2    = (regs[1] >> 5) & 1;
+    bool avx512f = (regs[1] >> 16) & 1;
+
+    if (avx2) {
+        best = Isa::AVX2;
+    }
+    // AVX-512 also needs the OS to save opmask and upper ZMM state.
+    if (avx2 && avx512f && osSupportsAvx(0xE6)) {
+        best = Isa::AVX512;
+    }
+    return best;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+const Kernels& kernels(Isa isa) {
+    isa = std::min(isa, detect());
+#if SIMD_X86
+    switch (isa) {
+        case Isa::AVX512: return AVX512_KERNELS;
+        case Isa::AVX2:   return AVX2_KERNELS;
+        case Isa::SSE2:   return SSE2_KERNELS;
+        case Isa::Scalar: return SCALAR_KERNELS;
+    }
+#endif
+    return SCALAR_KERNELS;
+}
+
+const Kernels& kernels() {
+    static const Kernels& selected = kernels(detect());
+    return selected;
+}
+
+std::string_view name(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE2:   return "sse2";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+}
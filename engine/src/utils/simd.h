@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "utils/types.h"
+
+/**
+ * Vectorized kernels over contiguous row-major f64 buffers, with the
+ * instruction set chosen once at startup from CPUID.
+ *
+ * Every kernel performs the same floating point operations in the same order
+ * as the scalar one, so all instruction sets agree bit-for-bit.
+ */
+namespace simd {
+
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+struct Kernels {
+    Isa isa;
+
+    /** out[k] = a[k] + b[k] for 0 <= k < size. out may alias a or b. */
+    void (*add)(const f64* a, const f64* b, f64* out, size_t size);
+
+    /** out[k] = a[k] * scalar for 0 <= k < size. out may alias a. */
+    void (*scale)(const f64* a, f64 scalar, f64* out, size_t size);
+
+    /**
+     * out = a * b, where a is m x k, b is k x n and out is m x n.
+     * Pre: out does not alias a or b.
+     */
+    void (*mul)(const f64* a, const f64* b, f64* out, size_t m, size_t k, size_t n);
+
+    /**
+     * out = a^T, where a is m x n and out is n x m.
+     * Pre: out does not alias a.
+     */
+    void (*transpose)(const f64* a, f64* out, size_t m, size_t n);
+
+    /**
+     * s[k] = sin(x[k]), c[k] = cos(x[k]) for 0 <= k < size, within 2 ulp
+     * for |x[k]| < 2^20 * pi / 2. s may alias x.
+     * Pre: c does not alias x or s.
+     */
+    void (*sincos)(const f64* x, f64* s, f64* c, size_t size);
+
+    /**
+     * Point-mass field at nq query points from nb bodies, vectorized over the
+     * query points. For each k < nq, summing over b in ascending order,
+     *   ax[k] = sum gm[b] * (bx[b] - qx[k]) / (d^3 + eps), likewise ay[k],
+     *   phi[k] = sum gm[b] / (d + eps),
+     * where d is the distance between query k and body b. phi may be null,
+     * which skips the potential.
+     * Pre: ax, ay and phi do not alias the inputs.
+     */
+    void (*gravity)(
+        const f64* qx, const f64* qy, size_t nq,
+        const f64* bx, const f64* by, const f64* gm, size_t nb,
+        f64 eps, f64* ax, f64* ay, f64* phi
+    );
+};
+
+/**
+ * Returns the best instruction set supported by the running CPU and OS.
+ */
+Isa detect();
+
+/**
+ * Returns the kernels for the given instruction set.
+ * Falls back to the next best supported set if isa is not available.
+ */
+const Kernels& kernels(Isa isa);
+
+/**
+ * Returns the kernels selected for this machine on first use.
+ */
+const Kernels& kernels();
+
+std::string_view name(Isa isa);
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include "utils/arena.h"
+
+/**
+ * A fixed-size buffer of trivially copyable elements that stores up to N
+ * elements inline and only spills to the heap beyond that.
+ * Like a std::pmr container, a buffer is bound to the memory resource that was
+ * MemoryArena::current() when it was constructed, and spills only to it.
+ * Move-constructed buffers are the exception: they bind to the default
+ * resource, since a moved-to buffer (e.g. a returned Matrix) may outlive the
+ * ArenaScope of its source. Moves between buffers bound to different
+ * resources copy the elements.
+ * Abstraction function:
+ * SmallBuffer(size, fill) represents a sequence of 'size' elements, each 'fill'.
+ * The element at index k is accessed via operator[](k), 0 <= k < size.
+ */
+template <typename T, size_t N>
+class SmallBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallBuffer requires trivially copyable elements");
+
+public:
+    SmallBuffer() = default;
+
+    explicit SmallBuffer(size_t size, const T& fill = T{}) {
+        allocate(size);
+        std::fill_n(data(), size, fill);
+    }
+
+    SmallBuffer(std::initializer_list<T> values)
+        : SmallBuffer(values.begin(), values.end()) {}
+
+    template <std::forward_iterator It>
+    SmallBuffer(It first, It last) {
+        allocate(static_cast<size_t>(std::distance(first, last)));
+        std::copy(first, last, data());
+    }
+
+    SmallBuffer(const SmallBuffer& other) {
+        allocate(other.size_);
+        std::copy_n(other.data(), other.size_, data());
+    }
+
+    SmallBuffer(SmallBuffer&& other) noexcept
+        : resource_(std::pmr::get_default_resource()) {
+        if (other.heap_ && other.resource_ != resource_) {
+            allocate(other.size_);
+            std::copy_n(other.data(), other.size_, data());
+            return;
+        }
+        steal(other);
+    }
+
+    SmallBuffer& operator=(const SmallBuffer& other) {
+        if (this != &other) {
+            resize(other.size_);
+            std::copy_n(other.data(), other.size_, data());
+        }
+        return *this;
+    }
+
+    SmallBuffer& operator=(SmallBuffer&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.heap_ && resource_ != other.resource_) {
+            return *this = static_cast<const SmallBuffer&>(other);
+        }
+        release();
+        steal(other);
+        return *this;
+    }
+
+    ~SmallBuffer() { release(); }
+
+    inline size_t size() const { return size_; }
+    inline bool isInline() const { return heap_ == nullptr; }
+
+    inline T* data() { return heap_ ? heap_ : inline_; }
+    inline const T* data() const { return heap_ ? heap_ : inline_; }
+
+    inline T& operator[](size_t k) { return data()[k]; }
+    inline const T& operator[](size_t k) const { return data()[k]; }
+
+    inline T* begin() { return data(); }
+    inline T* end() { return data() + size_; }
+    inline const T* begin() const { return data(); }
+    inline const T* end() const { return data() + size_; }
+
+    /**
+     * Changes the number of elements, reusing the current storage when it is
+     * large enough. Element values are unspecified afterwards.
+     */
+    void resize(size_t size) {
+        if (size > capacity()) {
+            release();
+            allocate(size);
+        }
+        size_ = size;
+    }
+
+    friend bool operator==(const SmallBuffer& a, const SmallBuffer& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    /**
+     * Lexicographical comparison, as for std::vector.
+     */
+    friend auto operator<=>(const SmallBuffer& a, const SmallBuffer& b) {
+        return std::lexicographical_compare_three_way(
+            a.begin(), a.end(), b.begin(), b.end()
+        );
+    }
+
+private:
+    /**
+     * Representation invariant:
+     * - heap_ == nullptr iff the elements live in inline_, in which case size_ <= N.
+     * - otherwise heap_ owns an array of capacity_ >= size_ elements,
+     *   allocated from resource_.
+     * - resource_ != nullptr and never changes after construction.
+     */
+
+    inline size_t capacity() const { return heap_ ? capacity_ : N; }
+
+    void allocate(size_t size) {
+        if (size > N) {
+            heap_ = static_cast<T*>(resource_->allocate(size * sizeof(T), alignof(T)));
+            capacity_ = size;
+        }
+        size_ = size;
+    }
+
+    void release() {
+        if (heap_) {
+            resource_->deallocate(heap_, capacity_ * sizeof(T), alignof(T));
+        }
+        heap_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+    }
+
+    void steal(SmallBuffer& other) {
+        size_ = other.size_;
+        if (other.heap_) {
+            heap_ = std::exchange(other.heap_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
+        } else {
+            std::copy_n(other.inline_, other.size_, inline_);
+        }
+        other.size_ = 0;
+    }
+
+    T* heap_ = nullptr;
+    std::pmr::memory_resource* resource_ = MemoryArena::current();
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    T inline_[N];
+};
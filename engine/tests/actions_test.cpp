@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "simulation/actions.h"
+
+namespace {
+
+WorldData orbitingWorld() {
+    shared_vec<CelestialBody> bodies;
+    for (u32 i = 0; i < 16; ++i) {
+        f64 r = 2e3 * (i + 1);
+        bodies.push_back(std::make_shared<OrbitingBody>(
+            i, 10.0, 1e21, std::make_unique<EllipticalOrbit>(r, 0.8 * r, 1e-4 * (i + 1), 0.1 * i, Vec2(0.0, 0.0), 0.0)
+        ));
+    }
+    bodies.push_back(std::make_shared<StationaryBody>(16, 50.0, 5e22, Vec2(1e3, -2e3)));
+    return WorldData(bodies, {}, {}, 1e6);
+}
+
+}
+
+TEST(ThrustActionModelTest, LockstepMatchesOneByOne) {
+    auto world = orbitingWorld();
+    ref::NaiveWorldIndex index(world);
+    Spacecraft ship(0, 1e3, 500.0, 0.0, {0.0, 50.0, 200.0}, 3.0);
+    std::vector<f64> directions;
+    for (int k = 0; k < 8; ++k) {
+        directions.push_back(k * MathConfig::pi / 4.0);
+    }
+    StateVertex from(Vec2(9e3, 7e3), Vec2(-1.5, 2.0), 1234.5, 500.0);
+
+    for (f64 quantum : {0.0, 1.0}) {
+        ref::ConcreteEnvironment env(world, quantum);
+        ref::SimpleTimePolicy time_policy(env, 1e9, 120.0);
+        ThrustActionModel one_by_one(env, time_policy, index, world, ship, directions);
+        ThrustActionModel lockstep(
+            env, time_policy, index, world, ship, directions,
+            PropagationConfig(IntegratorKind::RK4, 1e-9, 1e-9, 1000, IntegratorKind::RK4, 1, true)
+        );
+
+        auto actions = lockstep.enumerate(from);
+        lockstep.beginExpansion(from);
+        auto batched = lockstep.applyAll(from, actions);
+        ASSERT_EQ(batched.size(), actions.size());
+
+        one_by_one.beginExpansion(from);
+        for (size_t k = 0; k < actions.size(); ++k) {
+            auto expected = one_by_one.apply(from, actions[k]);
+            ASSERT_EQ(batched[k].has_value(), expected.has_value()) << "quantum " << quantum << ", action " << k;
+            if (expected) {
+                EXPECT_TRUE(*batched[k] == *expected) << "quantum " << quantum << ", action " << k;
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "simulation/body_soa.h"
+
+namespace {
+
+BodySoA ellipticalSoA(const std::vector<EllipticalBodyData>& bodies) {
+    return BodySoA({}, bodies, {});
+}
+
+}
+
+TEST(BodySoATest, EllipticalPositionsMatchOrbit) {
+    std::vector<EllipticalBodyData> bodies = {
+        {1, 0, 10.0, 1e20, EllipticalOrbit(1e4, 5e3, 1e-4, 0.3, Vec2(100.0, -50.0), 0.7)},
+        {2, 1, 10.0, 1e20, EllipticalOrbit(2e3, 2e3, 2e-3, 5.0, Vec2(0.0, 0.0), 0.0)},
+    };
+    auto soa = ellipticalSoA(bodies);
+    std::vector<f64> xs(2), ys(2);
+    for (f64 t : {0.0, 1.0, 1234.5, -987.0, 3e6}) {
+        soa.positionsAt(t, xs, ys);
+        for (size_t k = 0; k < bodies.size(); ++k) {
+            auto p = bodies[k].pos(t);
+            EXPECT_NEAR(xs[k], p.x, 1e-9 * bodies[k].orbit.a) << "t = " << t;
+            EXPECT_NEAR(ys[k], p.y, 1e-9 * bodies[k].orbit.a) << "t = " << t;
+        }
+    }
+}
+
+TEST(BodySoATest, LargePhasesStayOnTheOrbit) {
+    // omega * t is far beyond the range the vectorized sincos is accurate on.
+    const f64 a = 1e4, b = 4e3;
+    std::vector<EllipticalBodyData> bodies = {
+        {1, 0, 10.0, 1e20, EllipticalOrbit(a, b, 1.0, 0.25, Vec2(0.0, 0.0), 0.0)},
+    };
+    auto soa = ellipticalSoA(bodies);
+    std::vector<f64> xs(1), ys(1);
+    for (f64 t : {1e7, 3.3e8, 1e12, 1e16, 1e18, 1e22}) {
+        soa.positionsAt(t, xs, ys);
+        f64 u = xs[0] / a, v = ys[0] / b;
+        EXPECT_NEAR(u * u + v * v, 1.0, 1e-12) << "t = " << t;
+    }
+}
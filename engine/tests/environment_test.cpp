@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "simulation/world.h"
+#include "simulation/barnes_hut.h"
+
+namespace {
+
+/**
+ * Uniform motion, a trajectory without a closed-form orbit.
+ */
+struct LinearTrajectory : TrajectoryStrategy {
+    Vec2 p0, v;
+
+    LinearTrajectory(const Vec2& p0, const Vec2& v) : p0(p0), v(v) {}
+
+    Vec2 pos(f64 t) const override { return p0 + v * t; }
+};
+
+WorldData orbitingWorld() {
+    shared_vec<CelestialBody> bodies;
+    for (u32 i = 0; i < 16; ++i) {
+        f64 r = 2e3 * (i + 1);
+        bodies.push_back(std::make_shared<OrbitingBody>(
+            i, 10.0, 1e21, std::make_unique<EllipticalOrbit>(r, 0.8 * r, 1e-4 * (i + 1), 0.1 * i, Vec2(0.0, 0.0), 0.0)
+        ));
+    }
+    bodies.push_back(std::make_shared<StationaryBody>(16, 50.0, 5e22, Vec2(1e3, -2e3)));
+    return WorldData(bodies, {}, {}, 1e6);
+}
+
+}
+
+TEST(ConcreteEnvironmentTest, CachedQueriesAreThreadSafe) {
+    auto world = orbitingWorld();
+    ref::ConcreteEnvironment env(world, 1.0);
+
+    // Single-threaded reference, one fresh cache per time as in an expansion.
+    constexpr size_t TIMES = 2000;
+    std::vector<Vec2> expected(TIMES);
+    for (size_t k = 0; k < TIMES; ++k) {
+        env.resetCache();
+        expected[k] = env.gravity(Vec2(500.0, 700.0), 37.0 * k);
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<size_t> mismatches(4, 0);
+    for (size_t w = 0; w < mismatches.size(); ++w) {
+        threads.emplace_back([&, w] {
+            for (size_t rep = 0; rep < 5; ++rep) {
+                for (size_t k = w; k < TIMES; k += 3) {
+                    if (env.gravity(Vec2(500.0, 700.0), 37.0 * k) != expected[k]) {
+                        ++mismatches[w];
+                    }
+                }
+                env.resetCache();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t w = 0; w < mismatches.size(); ++w) {
+        EXPECT_EQ(mismatches[w], 0u) << "thread " << w;
+    }
+}
+
+TEST(ConcreteEnvironmentTest, FarTimesBypassTheCache) {
+    auto world = orbitingWorld();
+    ref::ConcreteEnvironment cached(world, 1e-6), direct(world);
+    for (f64 t_u : {1e13, -1e13, 1e30, 1e300}) {
+        EXPECT_EQ(cached.gravity(Vec2(500.0, 700.0), t_u), direct.gravity(Vec2(500.0, 700.0), t_u))
+            << "t_u = " << t_u;
+    }
+}
+
+TEST(BarnesHutEnvironmentTest, RequiresPositiveTimeSlice) {
+    auto world = orbitingWorld();
+    EXPECT_THROW(ref::BarnesHutEnvironment(world, 0.5, 0.0), std::runtime_error);
+    EXPECT_THROW(ref::BarnesHutEnvironment(world, 0.5, -1.0), std::runtime_error);
+}
+
+TEST(BarnesHutEnvironmentTest, CachedQueriesAreThreadSafe) {
+    auto world = orbitingWorld();
+    ref::BarnesHutEnvironment env(world, 0.5, 10.0);
+
+    constexpr size_t TIMES = 500;
+    std::vector<Vec2> expected(TIMES);
+    for (size_t k = 0; k < TIMES; ++k) {
+        env.resetCache();
+        expected[k] = env.gravity(Vec2(500.0, 700.0), 37.0 * k);
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<size_t> mismatches(4, 0);
+    for (size_t w = 0; w < mismatches.size(); ++w) {
+        threads.emplace_back([&, w] {
+            for (size_t rep = 0; rep < 5; ++rep) {
+                for (size_t k = w; k < TIMES; k += 3) {
+                    if (env.gravity(Vec2(500.0, 700.0), 37.0 * k) != expected[k]) {
+                        ++mismatches[w];
+                    }
+                }
+                env.resetCache();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t w = 0; w < mismatches.size(); ++w) {
+        EXPECT_EQ(mismatches[w], 0u) << "thread " << w;
+    }
+}
+
+TEST(ConcreteEnvironmentTest, EvaluateBatchMatchesEvaluate) {
+    auto world = orbitingWorld();
+    for (f64 quantum : {0.0, 1.0}) {
+        ref::ConcreteEnvironment env(world, quantum);
+
+        // Runs of equal times, times sharing a cache slot, and lone times.
+        std::vector<f64> xs, ys, vxs, vys, ts;
+        for (size_t k = 0; k < 40; ++k) {
+            xs.push_back(-3e4 + 1.7e3 * k);
+            ys.push_back(2e4 - 1.1e3 * k);
+            vxs.push_back(0.3 * k);
+            vys.push_back(-0.2 * k);
+            ts.push_back(k < 10 ? 100.0 : k < 20 ? 200.0 + 0.01 * k : 300.0 + 7.0 * k);
+        }
+        std::vector<FieldSample> out(xs.size());
+        env.evaluateBatch(xs, ys, vxs, vys, ts, out);
+
+        for (size_t k = 0; k < xs.size(); ++k) {
+            auto expected = env.evaluate(Vec2(xs[k], ys[k]), Vec2(vxs[k], vys[k]), ts[k]);
+            EXPECT_EQ(out[k].acceleration, expected.acceleration) << "quantum " << quantum << ", k " << k;
+            EXPECT_EQ(out[k].potential, expected.potential) << "quantum " << quantum << ", k " << k;
+            EXPECT_EQ(out[k].gamma, expected.gamma) << "quantum " << quantum << ", k " << k;
+        }
+    }
+}
+
+TEST(WorldDataTest, BodyBoundsCoverDiscsOfOtherBodies) {
+    // A body without a closed-form orbit has no analytic extent, so the
+    // bounds fall back to max_radius; its disc may still reach past that.
+    shared_vec<CelestialBody> bodies;
+    bodies.push_back(std::make_shared<OrbitingBody>(0, 500.0, 1e21, std::make_unique<LinearTrajectory>(
+        Vec2(9e3, 0.0), Vec2(1.0, 0.0)
+    )));
+    WorldData world(bodies, {}, {}, 1e4);
+    ASSERT_EQ(world.otherBodies().size(), 1u);
+    EXPECT_EQ(world.maxBodyRadius(), 500.0);
+    EXPECT_TRUE(world.bodyBounds().contains(Vec2(1e4 + 400.0, 0.0)));
+    EXPECT_TRUE(world.bodyBounds().contains(Vec2(0.0, -1e4 - 400.0)));
+}
+
+TEST(WorldDataTest, TabulatedEllipsesCountAsElliptical) {
+    shared_vec<CelestialBody> bodies;
+    bodies.push_back(std::make_shared<OrbitingBody>(0, 50.0, 1e21, std::make_unique<TabulatedTrajectory>(
+        std::make_unique<EllipticalOrbit>(1e3, 8e2, 1e-3, 0.2, Vec2(4e3, 0.0), 0.3), 0.0, 0.0, 64
+    )));
+    WorldData world(bodies, {}, {}, 1e5);
+    ASSERT_EQ(world.ellipticalBodies().size(), 1u);
+    EXPECT_TRUE(world.otherBodies().empty());
+
+    // Bounds from the source orbit, not from max_radius.
+    EXPECT_EQ(world.bodyBounds().hi.x, 4e3 + 1e3 + 50.0);
+
+    // Positions come from the source orbit.
+    const auto& orbit = world.ellipticalBodies().front().orbit;
+    std::vector<f64> xs(1), ys(1);
+    for (f64 t : {0.0, 123.4, 5e3}) {
+        world.bodySoA().positionsAt(t, xs, ys);
+        auto expected = orbit.pos(t);
+        EXPECT_NEAR(xs[0], expected.x, 1e-9) << "t = " << t;
+        EXPECT_NEAR(ys[0], expected.y, 1e-9) << "t = " << t;
+    }
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "simulation/field_grid.h"
+
+namespace {
+
+constexpr f64 HALF_SIDE = 1e5, EXTENT = 1.2e5;     // km
+
+/**
+ * Bodies of 50 km radius and 1e22 kg, scattered over [-HALF_SIDE, HALF_SIDE]^2.
+ */
+std::vector<StationaryBodyData> randomBodies(std::mt19937_64& gen, u32 count) {
+    std::uniform_real_distribution<f64> coord(-HALF_SIDE, HALF_SIDE);
+    std::vector<StationaryBodyData> bodies;
+    for (u32 i = 0; i < count; ++i) {
+        bodies.push_back({i, i, 50.0, 1e22, Vec2(coord(gen), coord(gen))});
+    }
+    return bodies;
+}
+
+f64 nearestBody(const std::vector<StationaryBodyData>& bodies, const Vec2& p) {
+    f64 d = INFINITY;
+    for (const auto& body : bodies) {
+        d = std::min(d, MathConfig::dist(p, body.position));
+    }
+    return d;
+}
+
+void expectBitExact(const StaticFieldGrid& grid, const Vec2& p) {
+    Vec2 a(1.0, -2.0), a_exact(1.0, -2.0);
+    f64 phi = 3.0, phi_exact = 3.0;
+    grid.accumulate(p, a, phi);
+    grid.accumulateExact(p, a_exact, phi_exact);
+    EXPECT_EQ(a, a_exact) << "at (" << p.x << ", " << p.y << ")";
+    EXPECT_EQ(phi, phi_exact) << "at (" << p.x << ", " << p.y << ")";
+}
+
+}
+
+TEST(StaticFieldGridTest, FarFieldMatchesExactSum) {
+    std::mt19937_64 gen(7);
+    auto bodies = randomBodies(gen, 20);
+    constexpr u32 CELLS = 256;
+    StaticFieldGrid grid(bodies, EXTENT, CELLS, 4.0);
+    f64 h = 2.0 * EXTENT / CELLS;
+
+    // Hermite interpolation errs by O((h / d)^4) in the potential and
+    // O((h / d)^3) in its gradient; at d >= 8 h both stay well below 1e-3.
+    std::uniform_real_distribution<f64> coord(-EXTENT, EXTENT);
+    size_t checked = 0;
+    for (size_t k = 0; k < 20000; ++k) {
+        Vec2 p(coord(gen), coord(gen));
+        if (nearestBody(bodies, p) < 8.0 * h) {
+            continue;
+        }
+        Vec2 a, a_exact;
+        f64 phi = 0.0, phi_exact = 0.0;
+        grid.accumulate(p, a, phi);
+        grid.accumulateExact(p, a_exact, phi_exact);
+
+        // Pulls can cancel, so the acceleration error is relative to their sum.
+        f64 pull = 0.0;
+        for (const auto& body : bodies) {
+            pull += MathConfig::G * body.mass / MathConfig::distSq(p, body.position);
+        }
+        ASSERT_LT(MathConfig::dist(a, a_exact), 1e-3 * pull) << "at (" << p.x << ", " << p.y << ")";
+        ASSERT_LT(std::abs(phi - phi_exact), 2e-5 * std::abs(phi_exact)) << "at (" << p.x << ", " << p.y << ")";
+        ++checked;
+    }
+    EXPECT_GT(checked, 10000u);
+}
+
+TEST(StaticFieldGridTest, NearFieldAndOffGridAreExact) {
+    std::mt19937_64 gen(11);
+    auto bodies = randomBodies(gen, 20);
+    StaticFieldGrid grid(bodies, EXTENT, 256, 4.0);
+
+    // Within 4 radii of a body the cell is summed exactly.
+    std::uniform_real_distribution<f64> angle(0.0, 2.0 * MathConfig::pi), dist(0.0, 200.0);
+    for (const auto& body : bodies) {
+        for (u32 k = 0; k < 16; ++k) {
+            f64 theta = angle(gen), r = dist(gen);
+            expectBitExact(grid, body.position + Vec2(r * std::cos(theta), r * std::sin(theta)));
+        }
+    }
+
+    // So is everything outside [-EXTENT, EXTENT]^2, including NaN.
+    std::uniform_real_distribution<f64> coord(-2.0 * EXTENT, 2.0 * EXTENT);
+    for (u32 k = 0; k < 256; ++k) {
+        Vec2 p(coord(gen), coord(gen));
+        if (std::abs(p.x) > EXTENT || std::abs(p.y) > EXTENT) {
+            expectBitExact(grid, p);
+        }
+    }
+    expectBitExact(grid, Vec2(EXTENT + 1e-6, 0.0));
+    expectBitExact(grid, Vec2(0.0, -EXTENT - 1e-6));
+
+    Vec2 a;
+    f64 phi = 0.0;
+    grid.accumulate(Vec2(NAN, 0.0), a, phi);
+    EXPECT_TRUE(std::isnan(phi));
+}
+
+TEST(StaticFieldGridTest, SingleCell) {
+    // One cell over the whole square, with the only body well outside it.
+    std::vector<StationaryBodyData> bodies{{0, 0, 50.0, 1e22, Vec2(5.0 * EXTENT, 2.0 * EXTENT)}};
+    StaticFieldGrid grid(bodies, EXTENT, 1, 4.0);
+    ASSERT_EQ(grid.cells(), 1u);
+
+    // The interpolant takes the node values and gradients at the corners,
+    // including the far edges, which belong to the only cell.
+    for (f64 x : {-EXTENT, EXTENT}) {
+        for (f64 y : {-EXTENT, EXTENT}) {
+            Vec2 a, a_exact;
+            f64 phi = 0.0, phi_exact = 0.0;
+            grid.accumulate(Vec2(x, y), a, phi);
+            grid.accumulateExact(Vec2(x, y), a_exact, phi_exact);
+            EXPECT_NEAR(phi, phi_exact, 1e-12 * std::abs(phi_exact));
+            EXPECT_LT(MathConfig::dist(a, a_exact), 1e-12 * std::sqrt(MathConfig::norm2Sq(a_exact)));
+        }
+    }
+
+    // Here h / d ~ 1/2, so the centre is only roughly right.
+    Vec2 a, a_exact;
+    f64 phi = 0.0, phi_exact = 0.0;
+    grid.accumulate(Vec2(), a, phi);
+    grid.accumulateExact(Vec2(), a_exact, phi_exact);
+    EXPECT_NEAR(phi, phi_exact, 1e-2 * std::abs(phi_exact));
+    EXPECT_LT(MathConfig::dist(a, a_exact), 0.1 * std::sqrt(MathConfig::norm2Sq(a_exact)));
+}
+
+TEST(StaticFieldGridTest, RejectsBadParameters) {
+    std::vector<StationaryBodyData> bodies;
+    EXPECT_THROW(StaticFieldGrid(bodies, 0.0, 16, 4.0), std::runtime_error);
+    EXPECT_THROW(StaticFieldGrid(bodies, EXTENT, 0, 4.0), std::runtime_error);
+    EXPECT_THROW(StaticFieldGrid(bodies, EXTENT, 16, -1.0), std::runtime_error);
+}
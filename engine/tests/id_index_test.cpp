@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "simulation/world.h"
+
+namespace {
+
+shared_vec<Artifact> artifactsWithIds(const std::vector<u32>& ids) {
+    shared_vec<Artifact> artifacts;
+    for (u32 id : ids) {
+        artifacts.push_back(std::make_shared<Artifact>(id, Vec2()));
+    }
+    return artifacts;
+}
+
+void expectFindsEverySlot(const IdIndex& index, const std::vector<u32>& ids) {
+    for (u32 slot = 0; slot < ids.size(); ++slot) {
+        EXPECT_EQ(index.find(ids[slot]), slot) << "id " << ids[slot];
+    }
+}
+
+}
+
+TEST(IdIndexTest, CompactIdsUseDenseTable) {
+    std::vector<u32> ids(100);
+    for (u32 k = 0; k < ids.size(); ++k) {
+        ids[k] = 3 * k + 7;
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937_64(3));
+    IdIndex index(artifactsWithIds(ids));
+
+    EXPECT_TRUE(index.isDense());
+    expectFindsEverySlot(index, ids);
+    for (u32 miss : {0u, 6u, 8u, 3u * 99 + 8, 3u * 99 + 7 + 1000, IdIndex::NONE}) {
+        EXPECT_EQ(index.find(miss), IdIndex::NONE) << "id " << miss;
+    }
+}
+
+TEST(IdIndexTest, SwitchesToHashMapPastDenseLimit) {
+    // Dense while max_id < 4 * size + 64; 10 entities allow ids up to 103.
+    std::vector<u32> ids{0, 1, 2, 3, 4, 5, 6, 7, 8, 103};
+    IdIndex at_limit(artifactsWithIds(ids));
+    EXPECT_TRUE(at_limit.isDense());
+    expectFindsEverySlot(at_limit, ids);
+
+    ids.back() = 104;
+    IdIndex past_limit(artifactsWithIds(ids));
+    EXPECT_FALSE(past_limit.isDense());
+    expectFindsEverySlot(past_limit, ids);
+    EXPECT_EQ(past_limit.find(103), IdIndex::NONE);
+    EXPECT_EQ(past_limit.find(9), IdIndex::NONE);
+}
+
+TEST(IdIndexTest, SparseIds) {
+    std::vector<u32> ids{4000000000u, 17, 1u << 20, 99999, 5};
+    IdIndex index(artifactsWithIds(ids));
+
+    EXPECT_FALSE(index.isDense());
+    expectFindsEverySlot(index, ids);
+    for (u32 miss : {0u, 6u, 18u, 1u << 21, IdIndex::NONE}) {
+        EXPECT_EQ(index.find(miss), IdIndex::NONE) << "id " << miss;
+    }
+}
+
+TEST(IdIndexTest, EmptyFindsNothing) {
+    IdIndex built(artifactsWithIds({})), defaulted;
+    for (const IdIndex* index : {&built, &defaulted}) {
+        EXPECT_TRUE(index->isDense());
+        EXPECT_EQ(index->find(0), IdIndex::NONE);
+        EXPECT_EQ(index->find(IdIndex::NONE), IdIndex::NONE);
+    }
+}
+
+TEST(IdIndexTest, RejectsDuplicateIds) {
+    EXPECT_THROW(IdIndex(artifactsWithIds({1, 2, 3, 2})), std::runtime_error);
+    EXPECT_THROW(IdIndex(artifactsWithIds({4000000000u, 5, 4000000000u})), std::runtime_error);
+}
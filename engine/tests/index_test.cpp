@@ -0,0 +1,283 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "simulation/index.h"
+
+namespace {
+
+constexpr f64 HALF_SIDE = 1e5;          // km
+
+/**
+ * Uniform motion, a trajectory without a closed-form orbit.
+ */
+struct LinearTrajectory : TrajectoryStrategy {
+    Vec2 p0, v;
+
+    LinearTrajectory(const Vec2& p0, const Vec2& v) : p0(p0), v(v) {}
+
+    Vec2 pos(f64 t) const override { return p0 + v * t; }
+};
+
+/**
+ * n bodies over a 2 * HALF_SIDE square, cycling through stationary bodies,
+ * ellipses with periods from minutes to years (so several swept-radius
+ * tiers), tabulated ellipses and uniformly moving bodies.
+ */
+WorldData randomWorld(size_t n, std::mt19937_64& gen) {
+    std::uniform_real_distribution<f64> coord(-HALF_SIDE, HALF_SIDE), unit(0.0, 1.0);
+    shared_vec<CelestialBody> bodies;
+    for (u32 i = 0; i < n; ++i) {
+        Vec2 center(coord(gen), coord(gen));
+        f64 radius = 1.0 + 50.0 * unit(gen);
+        if (i % 4 == 0) {
+            bodies.push_back(std::make_shared<StationaryBody>(i, radius, 1e20, center));
+            continue;
+        }
+        if (i % 4 == 3) {
+            Vec2 v(10.0 * (unit(gen) - 0.5), 10.0 * (unit(gen) - 0.5));
+            bodies.push_back(std::make_shared<OrbitingBody>(
+                i, radius, 1e20, std::make_unique<LinearTrajectory>(center, v)
+            ));
+            continue;
+        }
+        f64 a = 10.0 + 2e4 * unit(gen);
+        std::unique_ptr<const TrajectoryStrategy> orbit = std::make_unique<EllipticalOrbit>(
+            a, (0.3 + 0.7 * unit(gen)) * a, std::pow(10.0, -8.0 + 6.0 * unit(gen)),
+            6.28 * unit(gen), center, 6.28 * unit(gen)
+        );
+        if (i % 8 == 2) {
+            orbit = std::make_unique<TabulatedTrajectory>(std::move(orbit), 0.0, 1e5, 64);
+        }
+        bodies.push_back(std::make_shared<OrbitingBody>(i, radius, 1e20, std::move(orbit)));
+    }
+    return WorldData(bodies, {}, {}, 2.0 * HALF_SIDE);
+}
+
+template <typename T>
+std::vector<u32> ids(const shared_vec<T>& entities) {
+    std::vector<u32> result;
+    for (const auto& entity : entities) {
+        result.push_back(entity->id);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::pair<u32, Vec2>> visitedCelestials(
+    const WorldIndex& index, const Vec2& position, f64 radius, f64 t_u
+) {
+    std::vector<std::pair<u32, Vec2>> result;
+    index.visitCelestials(position, radius, t_u, [&](const CelestialBody& body, const Vec2& pos) {
+        result.push_back({body.id, pos});
+    });
+    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    return result;
+}
+
+}
+
+TEST(SweptWorldIndexTest, MatchesNaiveIndex) {
+    constexpr f64 HORIZON = 1e5, BUCKET_DT = 1e3;
+    std::mt19937_64 gen(7);
+    std::uniform_real_distribution<f64> coord(-HALF_SIDE, HALF_SIDE), unit(0.0, 1.0);
+    std::uniform_int_distribution<int> bucket(0, 100);
+
+    for (size_t w = 0; w < 12; ++w) {
+        auto world = randomWorld(40 + 40 * w, gen);
+        ref::NaiveWorldIndex naive(world);
+        ref::SweptWorldIndex swept(world, HORIZON, BUCKET_DT);
+        ASSERT_EQ(swept.bucketCount(), 100u);
+        EXPECT_GE(swept.tierCount(), 3u);
+
+        const auto& bodies = world.bodies();
+        for (size_t q = 0; q < 500; ++q) {
+            // Times inside buckets, on bucket edges, at the horizon and outside it.
+            f64 t_u;
+            switch (q % 5) {
+                case 0: t_u = HORIZON * unit(gen); break;
+                case 1: t_u = BUCKET_DT * bucket(gen); break;
+                case 2: t_u = -HORIZON * unit(gen); break;
+                case 3: t_u = HORIZON * (1.0 + unit(gen)); break;
+                default: t_u = (q % 2) ? HORIZON : std::nextafter(0.0, -1.0); break;
+            }
+            // Half the queries start near some body, so that they find it.
+            Vec2 position(coord(gen), coord(gen));
+            if (q % 2 == 0) {
+                const auto& body = *bodies[gen() % bodies.size()];
+                position = body.pos(t_u) + Vec2(100.0 * unit(gen), 100.0 * unit(gen));
+            }
+            f64 radius = std::array{0.0, 1.0, 60.0, 2e3, 3e4}[q % 5 == 4 ? 4 : gen() % 4];
+
+            SCOPED_TRACE(testing::Message() << "world " << w << ", query " << q << ", t_u " << t_u);
+            EXPECT_EQ(ids(swept.queryCelestials(position, radius, t_u)),
+                      ids(naive.queryCelestials(position, radius, t_u)));
+            EXPECT_EQ(visitedCelestials(swept, position, radius, t_u),
+                      visitedCelestials(naive, position, radius, t_u));
+        }
+    }
+}
+
+TEST(SweptWorldIndexTest, WithoutHorizonScans) {
+    std::mt19937_64 gen(8);
+    auto world = randomWorld(60, gen);
+    ref::NaiveWorldIndex naive(world);
+    ref::SweptWorldIndex swept(world, 0.0);
+    EXPECT_EQ(swept.bucketCount(), 0u);
+    for (f64 t_u : {-1e3, 0.0, 5e4}) {
+        EXPECT_EQ(ids(swept.queryCelestials(Vec2(0.0, 0.0), 5e4, t_u)),
+                  ids(naive.queryCelestials(Vec2(0.0, 0.0), 5e4, t_u)));
+    }
+}
+
+// ---------------- Nearest-neighbour and radius queries ----------------
+
+namespace {
+
+/**
+ * randomWorld(n_bodies) plus random artifacts and wormholes. Every fifth
+ * entity of each kind sits exactly on an earlier one, so distances tie.
+ */
+WorldData randomWorldWithPoints(size_t n_bodies, size_t n_points, std::mt19937_64& gen) {
+    auto bodies = randomWorld(n_bodies, gen).bodies();
+    std::uniform_real_distribution<f64> coord(-HALF_SIDE, HALF_SIDE);
+    shared_vec<Artifact> artifacts;
+    shared_vec<WormHole> wormholes;
+    for (u32 i = 0; i < n_points; ++i) {
+        Vec2 p = (i % 5 == 4) ? artifacts[i / 2]->position : Vec2(coord(gen), coord(gen));
+        artifacts.push_back(std::make_shared<Artifact>(1000 + i, p));
+        Vec2 entry = (i % 5 == 4) ? wormholes[i / 2]->entry : Vec2(coord(gen), coord(gen));
+        wormholes.push_back(std::make_shared<WormHole>(5000 + i, entry, Vec2(coord(gen), coord(gen)), 0.0, 1e9));
+    }
+    return WorldData(bodies, wormholes, artifacts, 2.0 * HALF_SIDE);
+}
+
+void expectSameNeighbors(const std::vector<Neighbor>& expected, const std::vector<Neighbor>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t k = 0; k < expected.size(); ++k) {
+        EXPECT_EQ(expected[k].id, actual[k].id) << "at " << k;
+        EXPECT_DOUBLE_EQ(expected[k].distance, actual[k].distance) << "at " << k;
+    }
+}
+
+template <typename Query>
+void expectSameRadiusQueries(const WorldIndex& expected, const WorldIndex& actual, Query&& query) {
+    EXPECT_EQ(ids(query(expected)), ids(query(actual)));
+}
+
+}
+
+TEST(KdTreeWorldIndexTest, KNearestMatchesScan) {
+    std::mt19937_64 gen(9);
+    std::uniform_real_distribution<f64> coord(-HALF_SIDE, HALF_SIDE), unit(0.0, 1.0);
+
+    for (size_t n : {0, 1, 7, 60, 400}) {
+        auto world = randomWorldWithPoints(n, n, gen);
+        ref::NaiveWorldIndex scan(world);       // WorldIndex::kNearest
+        ref::KdTreeWorldIndex kd(world);
+
+        for (size_t q = 0; q < 300; ++q) {
+            QueryFilter filter;
+            filter.kind = std::array{EntityKind::Celestial, EntityKind::WormHole, EntityKind::Artifact}[q % 3];
+
+            // Exclude a random subset of the ids of that kind.
+            uset<u32> excluded;
+            u32 base = filter.kind == EntityKind::Celestial ? 0 : filter.kind == EntityKind::WormHole ? 5000 : 1000;
+            for (size_t i = 0; i < n; ++i) {
+                if (q % 4 == 1 && unit(gen) < 0.3) {
+                    excluded.insert(base + static_cast<u32>(i));
+                }
+            }
+            filter.exclude = excluded.empty() ? nullptr : &excluded;
+            if (q % 4 == 2) {
+                filter.max_distance = 3e4 * unit(gen);
+            }
+
+            // Some queries sit exactly on an entity, with its duplicate as a tie.
+            Vec2 position(coord(gen), coord(gen));
+            if (q % 6 == 0 && n > 0) {
+                position = world.artifacts()[gen() % n]->position;
+            }
+            f64 t_u = 1e5 * unit(gen);
+            size_t k = std::array<size_t, 5>{0, 1, 3, 10, n + 5}[q % 5];
+
+            SCOPED_TRACE(testing::Message() << "n " << n << ", query " << q << ", k " << k);
+            expectSameNeighbors(
+                scan.kNearest(position, k, t_u, filter),
+                kd.kNearest(position, k, t_u, filter)
+            );
+
+            auto expected = scan.nearest(position, t_u, filter);
+            auto actual = kd.nearest(position, t_u, filter);
+            ASSERT_EQ(expected.has_value(), actual.has_value());
+            if (expected) {
+                EXPECT_EQ(expected->id, actual->id);
+                EXPECT_DOUBLE_EQ(expected->distance, actual->distance);
+            }
+        }
+    }
+}
+
+TEST(KdTreeWorldIndexTest, EmptyTreesFindNothing) {
+    WorldData world({}, {}, {}, 1e5);
+    ref::KdTreeWorldIndex kd(world);
+    for (auto kind : {EntityKind::Celestial, EntityKind::WormHole, EntityKind::Artifact}) {
+        QueryFilter filter;
+        filter.kind = kind;
+        EXPECT_TRUE(kd.kNearest(Vec2(1.0, 2.0), 5, 0.0, filter).empty());
+        EXPECT_FALSE(kd.nearest(Vec2(1.0, 2.0), 0.0, filter).has_value());
+    }
+    EXPECT_TRUE(kd.queryArtifacts(Vec2(0.0, 0.0), 1e9, 0.0).empty());
+    EXPECT_TRUE(kd.queryWormHoles(Vec2(0.0, 0.0), 1e9, 0.0).empty());
+    EXPECT_TRUE(kd.queryCelestials(Vec2(0.0, 0.0), 1e9, 0.0).empty());
+}
+
+TEST(PointIndexTest, RadiusQueriesMatchNaive) {
+    std::mt19937_64 gen(10);
+    std::uniform_real_distribution<f64> coord(-1.5 * HALF_SIDE, 1.5 * HALF_SIDE), unit(0.0, 1.0);
+
+    for (size_t n : {0, 1, 9, 300, 3000}) {
+        auto world = randomWorldWithPoints(n / 10, n, gen);
+        ref::NaiveWorldIndex naive(world);
+        ref::GridWorldIndex grid(world), coarse(world, 5e4);
+        ref::KdTreeWorldIndex kd(world);
+        const WorldIndex* indexes[] = {&grid, &coarse, &kd};
+
+        for (size_t q = 0; q < 300; ++q) {
+            // Queries on entities (radius 0 must still find them), and outside the grid box.
+            Vec2 position(coord(gen), coord(gen));
+            if (q % 4 == 0 && n > 0) {
+                position = world.artifacts()[gen() % n]->position;
+            } else if (q % 4 == 1 && n > 0) {
+                position = world.wormholes()[gen() % n]->entry;
+            }
+            f64 radius = std::array{0.0, MathConfig::epsilon, 500.0, 2e4, 4e5}[q % 5];
+            f64 t_u = 1e5 * unit(gen);
+
+            for (const auto* index : indexes) {
+                SCOPED_TRACE(testing::Message() << "n " << n << ", query " << q << ", radius " << radius);
+                expectSameRadiusQueries(naive, *index, [&](const WorldIndex& i) {
+                    return i.queryArtifacts(position, radius, t_u);
+                });
+                expectSameRadiusQueries(naive, *index, [&](const WorldIndex& i) {
+                    return i.queryWormHoles(position, radius, t_u);
+                });
+
+                std::vector<u32> visited;
+                index->visitArtifacts(position, radius, t_u, [&](const Artifact& a) { visited.push_back(a.id); });
+                index->visitWormHoles(position, radius, t_u, [&](const WormHole& wh) { visited.push_back(wh.id); });
+                std::sort(visited.begin(), visited.end());
+                auto expected = ids(naive.queryArtifacts(position, radius, t_u));
+                auto wormholes = ids(naive.queryWormHoles(position, radius, t_u));
+                expected.insert(expected.end(), wormholes.begin(), wormholes.end());
+                EXPECT_EQ(expected, visited);
+            }
+            EXPECT_EQ(visitedCelestials(kd, position, radius, t_u),
+                      visitedCelestials(naive, position, radius, t_u));
+        }
+    }
+}
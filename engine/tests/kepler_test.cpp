@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "simulation/patched_conics.h"
+
+namespace {
+
+constexpr f64 MU = 3.986e5;             // km^3 / s^2
+
+struct Orbit {
+    Vec2 x, v;
+
+    Orbit operator+(const Orbit& o) const { return {x + o.x, v + o.v}; }
+    Orbit operator*(f64 s) const { return {x * s, v * s}; }
+};
+
+/**
+ * Integrates (x, v) over dt with RK4 steps of at most h under accel(x).
+ */
+template <typename Accel>
+void fineStep(Vec2& x, Vec2& v, f64 dt, f64 h, Accel&& accel) {
+    MathConfig::RK4Workspace<Orbit> ws;
+    Orbit s{x, v};
+    u32 steps = static_cast<u32>(std::ceil(dt / h));
+    for (u32 i = 0; i < steps; ++i) {
+        MathConfig::rk4Step(s, 0.0, dt / steps, [&](const Orbit& o, f64, Orbit& out) {
+            out = {o.v, accel(o.x)};
+        }, ws);
+    }
+    x = s.x;
+    v = s.v;
+}
+
+Vec2 pointMass(const Vec2& x) {
+    f64 d2 = MathConfig::norm2Sq(x);
+    return x * (-MU / (d2 * std::sqrt(d2)));
+}
+
+/**
+ * keplerStep from periapsis at 7000 km with speed factor * circular speed
+ * over dt, against a fine RK4 reference.
+ */
+void expectMatchesReference(f64 speed_factor, f64 dt) {
+    Vec2 x0(7000.0, 0.0), v0(0.0, speed_factor * std::sqrt(MU / 7000.0));
+    Vec2 x = x0, v = v0;
+    f64 chi = 0.0;
+    ASSERT_TRUE(MathConfig::keplerStep(x, v, MU, dt, chi));
+
+    Vec2 x_ref = x0, v_ref = v0;
+    fineStep(x_ref, v_ref, dt, 0.05, pointMass);
+    EXPECT_LT(MathConfig::dist(x, x_ref), 1e-8) << "speed factor " << speed_factor;
+    EXPECT_LT(MathConfig::dist(v, v_ref), 1e-11) << "speed factor " << speed_factor;
+}
+
+}
+
+TEST(KeplerStepTest, EllipticArcMatchesReference) {
+    expectMatchesReference(1.2, 3000.0);   // e = 0.44
+}
+
+TEST(KeplerStepTest, ParabolicArcMatchesReference) {
+    expectMatchesReference(std::sqrt(2.0), 3000.0);
+}
+
+TEST(KeplerStepTest, HyperbolicArcMatchesReference) {
+    expectMatchesReference(2.0, 3000.0);
+}
+
+TEST(KeplerStepTest, ReturnsAfterOnePeriod) {
+    Vec2 x0(7000.0, 0.0), v0(0.0, 1.2 * std::sqrt(MU / 7000.0));
+    f64 a = 1.0 / (2.0 / 7000.0 - MathConfig::norm2Sq(v0) / MU);
+    f64 period = 2.0 * MathConfig::pi * std::sqrt(a * a * a / MU);
+
+    Vec2 x = x0, v = v0;
+    f64 chi = 0.0;
+    ASSERT_TRUE(MathConfig::keplerStep(x, v, MU, period, chi));
+    EXPECT_LT(MathConfig::dist(x, x0), 1e-6);
+    EXPECT_LT(MathConfig::dist(v, v0), 1e-9);
+}
+
+TEST(KeplerStepTest, BadWarmStartFallsBackToDefaultGuess) {
+    Vec2 x0(7000.0, 0.0), v0(0.0, 1.2 * std::sqrt(MU / 7000.0));
+
+    Vec2 x_cold = x0, v_cold = v0;
+    f64 chi_cold = 0.0;
+    ASSERT_TRUE(MathConfig::keplerStep(x_cold, v_cold, MU, 2000.0, chi_cold));
+
+    // Newton cannot converge from a NaN guess, so the default one is retried.
+    Vec2 x = x0, v = v0;
+    f64 chi = std::nan("");
+    ASSERT_TRUE(MathConfig::keplerStep(x, v, MU, 2000.0, chi));
+    EXPECT_EQ(x, x_cold);
+    EXPECT_EQ(v, v_cold);
+    EXPECT_EQ(chi, chi_cold);
+
+    // A good warm start converges to the same arc.
+    x = x0;
+    v = v0;
+    chi = chi_cold * 1.01;
+    ASSERT_TRUE(MathConfig::keplerStep(x, v, MU, 2000.0, chi));
+    EXPECT_NEAR(chi, chi_cold, 1e-9 * std::abs(chi_cold));
+    EXPECT_LT(MathConfig::dist(x, x_cold), 1e-8);
+}
+
+TEST(PatchedConicsTest, CoastSwitchesDominantBody) {
+    // Two stationary bodies; the ship crosses from the first's region into
+    // the second's during the coast.
+    shared_vec<CelestialBody> bodies;
+    f64 mass = MU / MathConfig::G;
+    bodies.push_back(std::make_shared<StationaryBody>(0, 10.0, mass, Vec2(0.0, 0.0)));
+    bodies.push_back(std::make_shared<StationaryBody>(1, 10.0, 0.5 * mass, Vec2(4e4, 0.0)));
+    WorldData world(bodies, {}, {}, 1e6);
+    ref::PatchedConicsEnvironment env(world);
+
+    Vec2 x0(1.2e4, 3e3), v0(9.0, 0.5);
+    ASSERT_EQ(env.dominantBody(x0, 0.0), 0u);
+
+    Vec2 x = x0, v = v0;
+    constexpr f64 DT = 2000.0;
+    ASSERT_TRUE(env.propagateCoast(x, v, 0.0, DT));
+    ASSERT_EQ(env.dominantBody(x, DT), 1u);
+
+    // Reference: the same dominant-body field, integrated in fine steps. The
+    // coast pins the crossing down to DT / 2^12 ~ 0.5 s, and the two fields
+    // differ by ~1.5e-3 km/s^2 there, so v may be off by ~1e-3 km/s and x by
+    // that over the rest of the coast.
+    Vec2 x_ref = x0, v_ref = v0;
+    fineStep(x_ref, v_ref, DT, 0.01, [&](const Vec2& p) { return env.gravity(p, 0.0); });
+    EXPECT_LT(MathConfig::dist(x, x_ref), 1.0);
+    EXPECT_LT(MathConfig::dist(v, v_ref), 1e-3);
+}
+
+TEST(PatchedConicsTest, ConcurrentCoastsAgree) {
+    shared_vec<CelestialBody> bodies;
+    for (u32 i = 0; i < 8; ++i) {
+        f64 r = 1e4 * (i + 2);
+        bodies.push_back(std::make_shared<OrbitingBody>(
+            i, 10.0, 1e23, std::make_unique<EllipticalOrbit>(r, r, 1e-6 * (i + 1), 0.3 * i, Vec2(0.0, 0.0), 0.0)
+        ));
+    }
+    WorldData world(bodies, {}, {}, 1e6);
+    ref::PatchedConicsEnvironment env(world);
+
+    auto coast = [&](size_t k) {
+        Vec2 x(3e4 + 100.0 * k, 2e4), v(1.0, -0.5);
+        env.propagateCoast(x, v, 10.0 * k, 600.0);
+        return x;
+    };
+    constexpr size_t CASES = 200;
+    std::vector<Vec2> expected(CASES);
+    for (size_t k = 0; k < CASES; ++k) {
+        expected[k] = coast(k);
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<size_t> mismatches(4, 0);
+    for (size_t w = 0; w < mismatches.size(); ++w) {
+        threads.emplace_back([&, w] {
+            for (size_t k = w; k < CASES; k += 2) {
+                mismatches[w] += coast(k) != expected[k];
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t w = 0; w < mismatches.size(); ++w) {
+        EXPECT_EQ(mismatches[w], 0u) << "thread " << w;
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <optional>
+
+#include "utils/arena.h"
+#include "utils/matrix.h"
+
+namespace {
+
+// rows x cols matrix holding 1, 2, ... in row-major order.
+Matrix iota(size_t rows, size_t cols) {
+    Matrix mat(rows, cols);
+    for (size_t k = 0; k < rows * cols; ++k) {
+        mat.data()[k] = static_cast<f64>(k + 1);
+    }
+    return mat;
+}
+
+Matrix transposed(const Matrix& mat) {
+    Matrix out(mat.cols(), mat.rows());
+    for (size_t i = 0; i < mat.rows(); ++i) {
+        for (size_t j = 0; j < mat.cols(); ++j) {
+            out(j, i) = mat(i, j);
+        }
+    }
+    return out;
+}
+
+}
+
+TEST(MatrixAssignTest, SelfTransposeViewSquare) {
+    auto a = iota(3, 3);
+    auto expected = transposed(a);
+    a = a.view().T();
+    EXPECT_EQ(a, expected);
+}
+
+TEST(MatrixAssignTest, SelfTransposeViewReshapes) {
+    // Inline (6 elements) and heap-backed (20 elements) buffers.
+    for (auto [rows, cols] : {std::pair<size_t, size_t>{2, 3}, {4, 5}}) {
+        auto a = iota(rows, cols);
+        auto expected = transposed(a);
+        a = a.view().T();
+        EXPECT_EQ(a, expected) << rows << "x" << cols;
+    }
+}
+
+TEST(MatrixAssignTest, SelfTransposeInsideExpression) {
+    auto a = iota(4, 4);
+    auto b = iota(4, 4);
+    Matrix expected = transposed(a) + b * 2.0;
+    a = a.view().T() + b * 2.0;
+    EXPECT_EQ(a, expected);
+}
+
+TEST(MatrixAssignTest, SelfBlockView) {
+    auto a = iota(4, 4);
+    Matrix expected = a.block(1, 1, 2, 3);
+    a = a.block(1, 1, 2, 3);
+    EXPECT_EQ(a, expected);
+}
+
+TEST(MatrixAssignTest, ElementWiseSelfReferenceStaysInPlace) {
+    auto a = iota(4, 5);
+    const f64* buffer = a.data();
+    Matrix expected = iota(4, 5) * 3.0;
+    a = a + a.view() * 2.0;
+    EXPECT_EQ(a, expected);
+    EXPECT_EQ(a.data(), buffer);
+}
+
+TEST(MatrixViewTest, AliasesDetectsOverlap) {
+    auto a = iota(4, 4);
+    auto b = iota(4, 4);
+    EXPECT_FALSE(a.view().aliases(a.data(), 16));
+    EXPECT_TRUE(a.view().T().aliases(a.data(), 16));
+    EXPECT_TRUE(a.row(3).aliases(a.data(), 16));
+    EXPECT_FALSE(a.row(3).aliases(a.data(), 12));
+    EXPECT_FALSE(a.view().T().aliases(b.data(), 16));
+}
+
+TEST(MatrixArenaTest, MoveOutOfScopeSurvivesReset) {
+    MemoryArena arena;
+    std::optional<Matrix> escaped;
+    {
+        ArenaScope scope(arena);
+        Matrix inner(5, 5, 1.0);
+        ASSERT_FALSE(inner.data() == nullptr);
+        escaped.emplace(std::move(inner));
+    }
+    {
+        // Reuses the memory the arena handed out above.
+        ArenaScope scope(arena);
+        Matrix clobber(5, 5, 7.0);
+        EXPECT_EQ(*escaped, Matrix(5, 5, 1.0));
+    }
+    EXPECT_EQ(*escaped, Matrix(5, 5, 1.0));
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "utils/simd.h"
+
+namespace {
+
+std::vector<f64> randomValues(size_t size, u32 seed, f64 lo = -10.0, f64 hi = 10.0) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<f64> dist(lo, hi);
+    std::vector<f64> values(size);
+    for (auto& v : values) {
+        v = dist(gen);
+    }
+    return values;
+}
+
+// Bitwise, so that -0.0 != 0.0 and NaNs compare by payload.
+void expectBitEqual(const std::vector<f64>& expected, const std::vector<f64>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t k = 0; k < expected.size(); ++k) {
+        ASSERT_EQ(std::bit_cast<u64>(expected[k]), std::bit_cast<u64>(actual[k]))
+            << "at " << k << ": " << expected[k] << " vs " << actual[k];
+    }
+}
+
+class SimdKernelsTest : public ::testing::TestWithParam<simd::Isa> {
+protected:
+    void SetUp() override {
+        if (simd::kernels(GetParam()).isa != GetParam()) {
+            GTEST_SKIP() << simd::name(GetParam()) << " is not supported on this CPU";
+        }
+    }
+
+    const simd::Kernels& scalar() const { return simd::kernels(simd::Isa::Scalar); }
+    const simd::Kernels& vector() const { return simd::kernels(GetParam()); }
+};
+
+// Sizes around every vector width, so each main loop and tail is covered.
+const size_t SIZES[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 127, 1000};
+
+}
+
+TEST_P(SimdKernelsTest, AddMatchesScalar) {
+    for (size_t size : SIZES) {
+        auto a = randomValues(size, 1), b = randomValues(size, 2);
+        std::vector<f64> expected(size), actual(size);
+        scalar().add(a.data(), b.data(), expected.data(), size);
+        vector().add(a.data(), b.data(), actual.data(), size);
+        expectBitEqual(expected, actual);
+
+        // In place.
+        vector().add(a.data(), b.data(), a.data(), size);
+        expectBitEqual(expected, a);
+    }
+}
+
+TEST_P(SimdKernelsTest, ScaleMatchesScalar) {
+    for (size_t size : SIZES) {
+        auto a = randomValues(size, 3);
+        std::vector<f64> expected(size), actual(size);
+        scalar().scale(a.data(), -0.37, expected.data(), size);
+        vector().scale(a.data(), -0.37, actual.data(), size);
+        expectBitEqual(expected, actual);
+
+        vector().scale(a.data(), -0.37, a.data(), size);
+        expectBitEqual(expected, a);
+    }
+}
+
+TEST_P(SimdKernelsTest, MulMatchesScalar) {
+    const size_t dims[] = {1, 2, 3, 5, 7, 8, 13, 32, 65};
+    for (size_t m : dims) {
+        for (size_t k : dims) {
+            for (size_t n : dims) {
+                auto a = randomValues(m * k, 4), b = randomValues(k * n, 5);
+                std::vector<f64> expected(m * n), actual(m * n);
+                scalar().mul(a.data(), b.data(), expected.data(), m, k, n);
+                vector().mul(a.data(), b.data(), actual.data(), m, k, n);
+                SCOPED_TRACE(testing::Message() << m << "x" << k << " * " << k << "x" << n);
+                expectBitEqual(expected, actual);
+            }
+        }
+    }
+}
+
+TEST_P(SimdKernelsTest, MulMatchesScalarOnBlockedSizes) {
+    // Large enough to take the tiled path, with ragged edge tiles.
+    const size_t m = 131, k = 197, n = 283;
+    auto a = randomValues(m * k, 6), b = randomValues(k * n, 7);
+    std::vector<f64> expected(m * n), actual(m * n);
+    scalar().mul(a.data(), b.data(), expected.data(), m, k, n);
+    vector().mul(a.data(), b.data(), actual.data(), m, k, n);
+    expectBitEqual(expected, actual);
+}
+
+TEST_P(SimdKernelsTest, TransposeMatchesScalar) {
+    const size_t dims[] = {1, 2, 3, 4, 5, 7, 8, 9, 17, 33, 100};
+    for (size_t m : dims) {
+        for (size_t n : dims) {
+            auto a = randomValues(m * n, 8);
+            std::vector<f64> expected(m * n), actual(m * n);
+            scalar().transpose(a.data(), expected.data(), m, n);
+            vector().transpose(a.data(), actual.data(), m, n);
+            SCOPED_TRACE(testing::Message() << m << "x" << n);
+            expectBitEqual(expected, actual);
+        }
+    }
+}
+
+TEST_P(SimdKernelsTest, SincosMatchesScalar) {
+    const f64 range = std::ldexp(1.0, 20) * 1.5707963267948966;
+    for (size_t size : SIZES) {
+        auto x = randomValues(size, 9, -range, range);
+        std::vector<f64> s0(size), c0(size), s1(size), c1(size);
+        scalar().sincos(x.data(), s0.data(), c0.data(), size);
+        vector().sincos(x.data(), s1.data(), c1.data(), size);
+        expectBitEqual(s0, s1);
+        expectBitEqual(c0, c1);
+    }
+}
+
+TEST_P(SimdKernelsTest, SincosMatchesScalarOnSpecialValues) {
+    std::vector<f64> x = {
+        0.0, -0.0, 1e-300, -1e-300, 0.5, 1.5707963267948966, 3.141592653589793,
+        -3.141592653589793, 6.283185307179586, 1e5, -1e5, 1.6e6
+    };
+    size_t size = x.size();
+    std::vector<f64> s0(size), c0(size), s1(size), c1(size);
+    scalar().sincos(x.data(), s0.data(), c0.data(), size);
+    vector().sincos(x.data(), s1.data(), c1.data(), size);
+    expectBitEqual(s0, s1);
+    expectBitEqual(c0, c1);
+}
+
+TEST_P(SimdKernelsTest, GravityMatchesScalar) {
+    const size_t bodies[] = {0, 1, 3, 50};
+    for (size_t nq : SIZES) {
+        for (size_t nb : bodies) {
+            auto qx = randomValues(nq, 10, -1e5, 1e5), qy = randomValues(nq, 11, -1e5, 1e5);
+            auto bx = randomValues(nb, 12, -1e5, 1e5), by = randomValues(nb, 13, -1e5, 1e5);
+            auto gm = randomValues(nb, 14, 1e2, 1e6);
+            // One query on top of a body, where only eps keeps the field finite.
+            if (nq > 0 && nb > 0) {
+                qx[0] = bx[0];
+                qy[0] = by[0];
+            }
+            std::vector<f64> ax0(nq), ay0(nq), phi0(nq), ax1(nq), ay1(nq), phi1(nq);
+            scalar().gravity(qx.data(), qy.data(), nq, bx.data(), by.data(), gm.data(), nb,
+                1e-9, ax0.data(), ay0.data(), phi0.data());
+            vector().gravity(qx.data(), qy.data(), nq, bx.data(), by.data(), gm.data(), nb,
+                1e-9, ax1.data(), ay1.data(), phi1.data());
+            SCOPED_TRACE(testing::Message() << nq << " queries, " << nb << " bodies");
+            expectBitEqual(ax0, ax1);
+            expectBitEqual(ay0, ay1);
+            expectBitEqual(phi0, phi1);
+
+            // Without the potential.
+            vector().gravity(qx.data(), qy.data(), nq, bx.data(), by.data(), gm.data(), nb,
+                1e-9, ax1.data(), ay1.data(), nullptr);
+            expectBitEqual(ax0, ax1);
+            expectBitEqual(ay0, ay1);
+        }
+    }
+}
+
+TEST(SimdScalarTest, SincosIsAccurateInRange) {
+    auto x = randomValues(4096, 10, -1e6, 1e6);
+    std::vector<f64> s(x.size()), c(x.size());
+    simd::kernels(simd::Isa::Scalar).sincos(x.data(), s.data(), c.data(), x.size());
+    for (size_t k = 0; k < x.size(); ++k) {
+        EXPECT_NEAR(s[k], std::sin(x[k]), 1e-15);
+        EXPECT_NEAR(c[k], std::cos(x[k]), 1e-15);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllIsas, SimdKernelsTest,
+    ::testing::Values(simd::Isa::SSE2, simd::Isa::AVX2, simd::Isa::AVX512),
+    [] (const auto& info) { return std::string(simd::name(info.param)); }
+);